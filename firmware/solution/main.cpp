@@ -1,53 +1,554 @@
+#include "src/async_writer.hpp"
+#include "src/bus_timing.hpp"
 #include "src/can_decode.hpp"
+#include "src/checkpoint.hpp"
+#include "src/frame_memo.hpp"
+#include "src/json_publisher.hpp"
+#include "src/latest_values.hpp"
+#include "src/log_follower.hpp"
+#include "src/range_check.hpp"
+#include "src/sample_sink.hpp"
+#include "src/shm_ring.hpp"
+#include "src/signal_history.hpp"
+#include "src/trigger.hpp"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstring>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
 
-int main() {
-    // Paths relative to repo root (/workspace at runtime)
-    const std::string dbc_control  = "dbc-files/ControlBus.dbc";   // can0/vcan0
-    const std::string dbc_sensor   = "dbc-files/SensorBus.dbc";    // can1/vcan1
-    const std::string dbc_tractive = "dbc-files/TractiveBus.dbc";  // can2/vcan2
+#include <sys/stat.h>
+#include <unistd.h>
 
-    auto net_can0 = rbk::load_network(dbc_control);
-    auto net_can1 = rbk::load_network(dbc_sensor);
-    auto net_can2 = rbk::load_network(dbc_tractive);
+static std::atomic<bool> g_stop{false};
 
-    if (!net_can0 || !net_can1 || !net_can2) {
-        std::cerr << "One or more DBCs failed to load. Exiting.\n";
+static void on_stop_signal(int) { g_stop.store(true); }
+
+static void usage(const char* argv0) {
+    std::cerr << "usage: " << argv0 << " [--publish host[:port]] [--publish-interval-ms N]\n"
+              << "       [--shm NAME] [--shm-capacity N] [--snapshot FILE]\n"
+              << "       [--timing-report FILE] [--timing-alerts] [--bitrate N] [--no-memo]\n"
+              << "       [--out-direct] [--out-sync] [--out-buffers N] [--out-buffer-kb N]\n"
+              << "       [--range-check POLICY] [--range-policy SIGNAL=POLICY] [--range-report FILE]\n"
+              << "       [--bus-config FILE] [--input FILE] [--follow] [--follow-idle-exit SEC]\n"
+              << "       [--checkpoint FILE] [--checkpoint-interval-s N]\n"
+              << "       [--trigger COND] [--trigger-pre SEC] [--trigger-post SEC] [--trigger-rate FPS]\n"
+              << "       [--trigger-prefix PATH] [--trigger-max N] [--history SEC]\n"
+              << "  --publish              stream decoded samples as JSON lines to the\n"
+              << "                         spyder streaming service (default port 12000)\n"
+              << "  --publish-interval-ms  batch per time slice instead of per frame\n"
+              << "  --shm                  publish samples into POSIX shared memory rings\n"
+              << "  --shm-capacity         records per ring (default 65536)\n"
+              << "  --snapshot             write the latest value of every signal at exit\n"
+              << "  --timing-report        per-ID inter-arrival/jitter/missed report vs\n"
+              << "                         GenMsgCycleTime, plus bus load\n"
+              << "  --timing-alerts        print late/missing-frame and bus-load alerts live\n"
+              << "  --bitrate              bus bitrate for load estimates (default 500000)\n"
+              << "  --no-memo              decode every frame, even when its payload repeats\n"
+              << "  --out-direct           open output.txt with O_DIRECT\n"
+              << "  --out-sync             write output.txt with a plain ofstream\n"
+              << "  --out-buffers          async output buffers (default 4)\n"
+              << "  --out-buffer-kb        size of each async output buffer (default 1024)\n"
+              << "  --range-check          validate values against DBC [min|max]; POLICY is\n"
+              << "                         count, flag, clamp or drop (default count)\n"
+              << "  --range-policy         per-signal policy override (repeatable)\n"
+              << "  --range-report         write the per-signal violation summary\n"
+              << "  --bus-config           interface -> DBC map, one \"iface dbc [alias...]\" per line\n"
+              << "                         (default: can0-2/vcan0-2 on dbc-files/*.dbc)\n"
+              << "  --input                log to decode (default dump.log)\n"
+              << "  --follow               keep decoding lines appended to the log until\n"
+              << "                         SIGINT/SIGTERM; survives truncation and rotation\n"
+              << "  --follow-idle-exit     stop following after SEC seconds without new lines\n"
+              << "  --checkpoint           save log offset, output length and sink state to\n"
+              << "                         FILE and resume from it on the next start (an\n"
+              << "                         unterminated last line is left for that start)\n"
+              << "  --checkpoint-interval-s  seconds between checkpoints while running, following\n"
+              << "                         or not (default 5)\n"
+              << "  --trigger              capture raw frames around \"SIGNAL OP VALUE\" (op > >= < <=\n"
+              << "                         == !=) becoming true; repeatable\n"
+              << "  --trigger-pre          seconds of history before the trigger (default 5)\n"
+              << "  --trigger-post         seconds after the trigger (default 5)\n"
+              << "  --trigger-rate         peak frames/s over all buses the history must hold\n"
+              << "                         (default 20000); the frame ring is allocated once at\n"
+              << "                         pre x rate frames, 80 bytes each\n"
+              << "  --trigger-ring         fix the frame ring at N frames instead\n"
+              << "  --trigger-prefix       capture files are PATH_NNN.log (default capture)\n"
+              << "  --trigger-max          captures to write before only counting (default 100)\n"
+              << "  --history              keep the last SEC seconds of every signal compressed in\n"
+              << "                         memory (Gorilla chunks) and report its footprint\n";
+}
+
+int main(int argc, char** argv) {
+    bool publish = false;
+    rbk::PublisherConfig pub_cfg;
+    bool shm = false;
+    rbk::ShmConfig shm_cfg;
+    std::string snapshot_path;
+    std::string timing_path;
+    bool timing_alerts = false;
+    rbk::TimingConfig timing_cfg;
+    bool memo_enabled = true;
+    rbk::WriterConfig out_cfg;
+    bool out_sync = false;
+    bool range_check = false;
+    rbk::RangePolicy range_default = rbk::RangePolicy::Count;
+    std::vector<std::pair<std::string, rbk::RangePolicy>> range_overrides;
+    std::string range_report_path;
+    std::string bus_config_path;
+    std::string input_path = "dump.log";
+    bool follow = false;
+    double follow_idle_exit_s = 0.0;
+    std::string checkpoint_path;
+    double checkpoint_interval_s = 5.0;
+    std::vector<rbk::TriggerSpec> trigger_specs;
+    rbk::TriggerConfig trigger_cfg;
+    bool history_enabled = false;
+    rbk::HistoryConfig history_cfg;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--publish") && i + 1 < argc) {
+            publish = true;
+            if (!rbk::parse_publish_target(argv[++i], pub_cfg)) {
+                std::cerr << "Bad --publish target: " << argv[i] << "\n";
+                return 1;
+            }
+        } else if (!std::strcmp(argv[i], "--publish-interval-ms") && i + 1 < argc) {
+            pub_cfg.flush_interval_ms = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--shm") && i + 1 < argc) {
+            shm = true;
+            shm_cfg.name = argv[++i];
+            if (shm_cfg.name.empty() || shm_cfg.name[0] != '/') shm_cfg.name = "/" + shm_cfg.name;
+        } else if (!std::strcmp(argv[i], "--shm-capacity") && i + 1 < argc) {
+            shm_cfg.ring_capacity = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (!std::strcmp(argv[i], "--snapshot") && i + 1 < argc) {
+            snapshot_path = argv[++i];
+        } else if (!std::strcmp(argv[i], "--timing-report") && i + 1 < argc) {
+            timing_path = argv[++i];
+        } else if (!std::strcmp(argv[i], "--timing-alerts")) {
+            timing_alerts = true;
+        } else if (!std::strcmp(argv[i], "--bitrate") && i + 1 < argc) {
+            timing_cfg.bitrate = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (!std::strcmp(argv[i], "--no-memo")) {
+            memo_enabled = false;
+        } else if (!std::strcmp(argv[i], "--out-direct")) {
+            out_cfg.direct = true;
+        } else if (!std::strcmp(argv[i], "--out-sync")) {
+            out_sync = true;
+        } else if (!std::strcmp(argv[i], "--out-buffers") && i + 1 < argc) {
+            out_cfg.buffers = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (!std::strcmp(argv[i], "--out-buffer-kb") && i + 1 < argc) {
+            out_cfg.buffer_bytes = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10)) * 1024;
+        } else if (!std::strcmp(argv[i], "--range-check") && i + 1 < argc) {
+            range_check = true;
+            if (!rbk::parse_range_policy(argv[++i], range_default)) {
+                std::cerr << "Bad --range-check policy: " << argv[i] << "\n";
+                return 1;
+            }
+        } else if (!std::strcmp(argv[i], "--range-policy") && i + 1 < argc) {
+            range_check = true;
+            const std::string arg = argv[++i];
+            const auto eq = arg.find('=');
+            rbk::RangePolicy p;
+            if (eq == std::string::npos || !rbk::parse_range_policy(arg.substr(eq + 1), p)) {
+                std::cerr << "Bad --range-policy (want SIGNAL=POLICY): " << arg << "\n";
+                return 1;
+            }
+            range_overrides.emplace_back(arg.substr(0, eq), p);
+        } else if (!std::strcmp(argv[i], "--bus-config") && i + 1 < argc) {
+            bus_config_path = argv[++i];
+        } else if (!std::strcmp(argv[i], "--range-report") && i + 1 < argc) {
+            range_check = true;
+            range_report_path = argv[++i];
+        } else if (!std::strcmp(argv[i], "--input") && i + 1 < argc) {
+            input_path = argv[++i];
+        } else if (!std::strcmp(argv[i], "--follow")) {
+            follow = true;
+        } else if (!std::strcmp(argv[i], "--follow-idle-exit") && i + 1 < argc) {
+            follow_idle_exit_s = std::atof(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--checkpoint") && i + 1 < argc) {
+            checkpoint_path = argv[++i];
+        } else if (!std::strcmp(argv[i], "--checkpoint-interval-s") && i + 1 < argc) {
+            checkpoint_interval_s = std::atof(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--trigger") && i + 1 < argc) {
+            rbk::TriggerSpec spec;
+            if (!rbk::parse_trigger(argv[++i], spec)) {
+                std::cerr << "Bad --trigger (want SIGNAL OP VALUE): " << argv[i] << "\n";
+                return 1;
+            }
+            trigger_specs.push_back(spec);
+        } else if (!std::strcmp(argv[i], "--trigger-pre") && i + 1 < argc) {
+            trigger_cfg.pre_ns = static_cast<int64_t>(std::atof(argv[++i]) * 1e9);
+        } else if (!std::strcmp(argv[i], "--trigger-post") && i + 1 < argc) {
+            trigger_cfg.post_ns = static_cast<int64_t>(std::atof(argv[++i]) * 1e9);
+        } else if (!std::strcmp(argv[i], "--trigger-rate") && i + 1 < argc) {
+            trigger_cfg.peak_fps = std::atof(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--trigger-ring") && i + 1 < argc) {
+            trigger_cfg.ring_frames = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (!std::strcmp(argv[i], "--trigger-prefix") && i + 1 < argc) {
+            trigger_cfg.prefix = argv[++i];
+        } else if (!std::strcmp(argv[i], "--trigger-max") && i + 1 < argc) {
+            trigger_cfg.max_captures = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (!std::strcmp(argv[i], "--history") && i + 1 < argc) {
+            history_enabled = true;
+            history_cfg.retention_ns = static_cast<int64_t>(std::atof(argv[++i]) * 1e9);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (out_cfg.direct && (follow || !checkpoint_path.empty())) {
+        // O_DIRECT only writes whole blocks, so output.txt could never be
+        // flushed to a line boundary for readers or a checkpoint.
+        std::cerr << "--out-direct cannot be combined with --follow or --checkpoint\n";
         return 1;
     }
 
-    auto map_can0 = rbk::build_msg_map(*net_can0);
-    auto map_can1 = rbk::build_msg_map(*net_can1);
-    auto map_can2 = rbk::build_msg_map(*net_can2);
+    // Interface -> DBC mapping; the built-in one is can0-2/vcan0-2 with DBC
+    // paths relative to repo root (/workspace at runtime).
+    rbk::BusMap bus_map = rbk::BusMap::builtin();
+    if (!bus_config_path.empty()) {
+        bus_map = rbk::BusMap();
+        std::string err;
+        if (!bus_map.load(bus_config_path, &err)) {
+            std::cerr << "Bus config: " << err << "\n";
+            return 1;
+        }
+    }
 
-    std::ifstream dump("dump.log");
-    if (!dump) {
-        std::cerr << "Could not open dump.log\n";
-        return 1;
+    // Bus index == position in the map == position in the catalog.
+    std::vector<std::unique_ptr<dbcppp::INetwork>> nets;
+    rbk::SignalCatalog catalog;
+    for (size_t b = 0; b < bus_map.size(); ++b) {
+        const rbk::BusConfig& bc = bus_map.bus(static_cast<uint8_t>(b));
+        nets.push_back(rbk::load_network(bc.dbc));
+        if (!nets.back()) {
+            std::cerr << "Failed to load " << bc.dbc << " for " << bc.name << ". Exiting.\n";
+            return 1;
+        }
+        catalog.add_bus(*nets.back());
+    }
+
+    // Resume only if the checkpoint describes this log (same inode, not
+    // shorter than what was consumed, same bytes before the offset) and
+    // output.txt still holds what was written up to it; otherwise start over.
+    rbk::CheckpointHeader resume;
+    bool resuming = false;
+    if (!checkpoint_path.empty()) {
+        std::string err;
+        struct stat log_st {}, out_st {};
+        if (!rbk::read_checkpoint(checkpoint_path, resume, {}, nullptr, &err)) {
+            if (::access(checkpoint_path.c_str(), F_OK) == 0) std::cerr << "Checkpoint ignored: " << err << "\n";
+        } else if (resume.log != input_path || ::stat(input_path.c_str(), &log_st) != 0 ||
+                   static_cast<uint64_t>(log_st.st_ino) != resume.inode ||
+                   static_cast<uint64_t>(log_st.st_size) < resume.offset ||
+                   (!resume.log_tail.empty() &&
+                    rbk::LogFollower::read_tail(input_path, resume.offset) != resume.log_tail) ||
+                   ::stat("output.txt", &out_st) != 0 ||
+                   static_cast<uint64_t>(out_st.st_size) < resume.output_bytes) {
+            std::cerr << "Checkpoint ignored: " << input_path << " or output.txt changed since it was taken\n";
+        } else {
+            resuming = true;
+        }
     }
-    std::ofstream out("output.txt");
-    if (!out) {
-        std::cerr << "Could not create output.txt\n";
+
+    rbk::LogFollower log(input_path, resuming ? resume.offset : 0);
+    if (!log.ok() && !follow) {
+        std::cerr << "Could not open " << input_path << "\n";
         return 1;
     }
+    // Decoding never waits on the disk unless every async buffer is in flight.
+    std::ofstream out_file;
+    std::unique_ptr<rbk::AsyncFileWriter> out_writer;
+    std::ostream out(nullptr);
+    if (out_sync) {
+        if (resuming) {
+            if (::truncate("output.txt", static_cast<off_t>(resume.output_bytes)) == 0) {
+                out_file.open("output.txt", std::ios::app);
+            }
+        } else {
+            out_file.open("output.txt");
+        }
+        if (!out_file) {
+            std::cerr << "Could not create output.txt\n";
+            return 1;
+        }
+        out.rdbuf(out_file.rdbuf());
+    } else {
+        if (resuming) out_cfg.resume_offset = static_cast<int64_t>(resume.output_bytes);
+        out_writer = std::make_unique<rbk::AsyncFileWriter>("output.txt", out_cfg);
+        if (!out_writer->ok()) {
+            std::cerr << "Could not create output.txt: " << out_writer->error() << "\n";
+            return 1;
+        }
+        out.rdbuf(out_writer.get());
+    }
     out.setf(std::ios::fmtflags(0), std::ios::floatfield);
     out << std::setprecision(15);
 
+    rbk::TextSink text(catalog, out);
+    rbk::SinkList sinks;
+    sinks.add(&text);
+
+    std::unique_ptr<rbk::JsonPublisher> publisher;
+    if (publish) {
+        publisher = std::make_unique<rbk::JsonPublisher>(catalog, pub_cfg);
+        sinks.add(publisher.get());
+    }
+
+    std::unique_ptr<rbk::LatestValueTable> latest;
+    if (!snapshot_path.empty()) {
+        latest = std::make_unique<rbk::LatestValueTable>(catalog);
+        sinks.add(latest.get());
+    }
+
+    std::unique_ptr<rbk::ShmPublisher> shm_pub;
+    if (shm) {
+        shm_pub = std::make_unique<rbk::ShmPublisher>(catalog, shm_cfg);
+        if (!shm_pub->ok()) {
+            std::cerr << "Shared memory: " << shm_pub->error() << "\n";
+            return 1;
+        }
+        sinks.add(shm_pub.get());
+    }
+
+    std::unique_ptr<rbk::BusTiming> timing;
+    if (!timing_path.empty() || timing_alerts) {
+        timing = std::make_unique<rbk::BusTiming>(timing_cfg);
+        for (size_t b = 0; b < nets.size(); ++b) timing->declare_network(static_cast<uint8_t>(b), *nets[b]);
+        if (timing_alerts) {
+            timing->set_alert_handler([](const rbk::TimingAlert& a) {
+                char ts[rbk::kTimestampBufLen];
+                const std::string when(ts, rbk::format_timestamp(a.ts_ns, ts));
+                // Formatted apart so std::cerr's flags and precision are left alone.
+                std::ostringstream os;
+                os << "[timing] " << rbk::to_string(a.kind) << " bus" << int(a.bus);
+                if (a.id) {
+                    os << " 0x" << std::hex << a.can_id << std::dec << ' '
+                       << (a.id->name.empty() ? "?" : a.id->name) << " gap "
+                       << a.gap_ns / 1e6 << " ms (cycle " << a.id->cycle_ms << " ms)";
+                } else {
+                    os << " load " << std::setprecision(3) << 100.0 * a.load << "%";
+                }
+                os << " @ " << when << "\n";
+                std::cerr << os.str();
+            });
+        }
+    }
+
+    std::unique_ptr<rbk::SignalHistory> history;
+    if (history_enabled) {
+        history = std::make_unique<rbk::SignalHistory>(catalog, history_cfg);
+        sinks.add(history.get());
+    }
+
+    std::unique_ptr<rbk::TriggerEngine> trigger;
+    if (!trigger_specs.empty()) {
+        trigger = std::make_unique<rbk::TriggerEngine>(catalog, bus_map, trigger_cfg);
+        for (const auto& spec : trigger_specs) {
+            std::string err;
+            if (!trigger->add(spec, &err)) {
+                std::cerr << "--trigger: " << err << "\n";
+                return 1;
+            }
+        }
+        sinks.add(trigger.get());
+    }
+
+    // Range validation sits in front of every sink so they all see the policy applied.
+    rbk::SampleSink* head = &sinks;
+    std::unique_ptr<rbk::RangeFilter> range;
+    if (range_check) {
+        range = std::make_unique<rbk::RangeFilter>(catalog, sinks, range_default);
+        for (const auto& o : range_overrides) {
+            if (!range->set_policy(o.first, o.second)) {
+                std::cerr << "--range-policy: unknown signal " << o.first << "\n";
+                return 1;
+            }
+        }
+        head = range.get();
+    }
+
+    rbk::FrameMemo memo(catalog);
+
+    // Components whose state is carried across restarts. The memo and the
+    // rendered-text cache are only caches and start cold.
+    std::vector<rbk::Checkpointable*> parts;
+    if (timing) parts.push_back(timing.get());
+    if (latest) parts.push_back(latest.get());
+    if (range) parts.push_back(range.get());
+
+    uint64_t lines = 0;
+    int64_t last_ts_ns = 0;
+    if (resuming) {
+        std::vector<std::string> skipped;
+        std::string err;
+        if (!rbk::read_checkpoint(checkpoint_path, resume, parts, &skipped, &err)) {
+            std::cerr << "Checkpoint: " << err << "\n";
+            return 1;
+        }
+        lines = resume.lines;
+        last_ts_ns = resume.last_ts_ns;
+        std::cout << "Resuming " << input_path << " at byte " << resume.offset << " (" << lines << " lines)\n";
+        for (const auto& k : skipped) std::cerr << "Checkpoint: no usable " << k << " state, starting it fresh\n";
+    }
+
+    // output.txt length with everything so far on disk (at a line boundary).
+    auto flush_output = [&]() -> uint64_t {
+        if (out_writer) {
+            out_writer->flush();
+            return out_writer->size();
+        }
+        out.flush();
+        struct stat st {};
+        return ::stat("output.txt", &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+    };
+    auto save_checkpoint = [&]() {
+        rbk::CheckpointHeader hdr;
+        hdr.log = input_path;
+        hdr.inode = log.inode();
+        hdr.offset = log.offset();
+        hdr.log_tail = log.tail();
+        hdr.lines = lines;
+        hdr.last_ts_ns = last_ts_ns;
+        hdr.output_bytes = flush_output();
+        std::string err;
+        if (!rbk::write_checkpoint(checkpoint_path, hdr, {parts.begin(), parts.end()}, &err)) {
+            std::cerr << "Checkpoint: " << err << "\n";
+        }
+    };
+
     std::string line;
     rbk::ParsedLine pl;
-    while (std::getline(dump, line)) {
-        if (!rbk::parse_line(line, pl)) continue;
+    auto on_line = [&](const char* p, size_t n) {
+        ++lines;
+        line.assign(p, n);
+        if (!rbk::parse_line(line, pl, bus_map) || pl.bus == rbk::kNoBus) return;
+        last_ts_ns = pl.ts_ns;
 
-        if (pl.iface == "can0") {
-            rbk::decode_and_write(pl, *net_can0, map_can0, out);
-        } else if (pl.iface == "can1") {
-            rbk::decode_and_write(pl, *net_can1, map_can1, out);
-        } else if (pl.iface == "can2") {
-            rbk::decode_and_write(pl, *net_can2, map_can2, out);
+        if (timing) timing->observe(pl.bus, pl);
+        if (trigger) trigger->record(pl);
+        if (memo_enabled) {
+            rbk::decode_frame(pl, pl.bus, catalog, *head, memo);
+        } else {
+            rbk::decode_frame(pl, pl.bus, catalog, *head);
+        }
+    };
+
+    // Lines per drain() call, so a long backlog is checkpointed as it goes
+    // rather than only once it has all been read.
+    constexpr size_t kDrainBatch = 1u << 16;
+    using clock = std::chrono::steady_clock;
+    const auto interval = std::chrono::duration<double>(checkpoint_interval_s);
+    auto last_checkpoint = clock::now();
+    auto checkpoint_due = [&]() -> bool {
+        if (checkpoint_path.empty() || clock::now() - last_checkpoint < interval) return false;
+        save_checkpoint();
+        last_checkpoint = clock::now();
+        return true;
+    };
+
+    if (follow) {
+        std::signal(SIGINT, on_stop_signal);
+        std::signal(SIGTERM, on_stop_signal);
+        const auto idle_exit = std::chrono::duration<double>(follow_idle_exit_s);
+        auto last_line = clock::now();
+        uint64_t rotations = log.rotations();
+        while (!g_stop.load()) {
+            const size_t n = log.drain(on_line, kDrainBatch);
+            if (n) last_line = clock::now();
+            if (log.rotations() != rotations) {
+                rotations = log.rotations();
+                std::cerr << input_path << " was truncated or replaced; reading it from the start\n";
+            }
+            const bool caught_up = n < kDrainBatch;
+            if (!checkpoint_due() && caught_up) flush_output(); // live readers see every complete line
+            if (follow_idle_exit_s > 0 && clock::now() - last_line >= idle_exit) break;
+            if (timing && caught_up && last_ts_ns) {
+                // Log time has moved on by however long the log has been quiet.
+                timing->tick(last_ts_ns + std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                              clock::now() - last_line).count());
+            }
+            if (caught_up) log.wait(1000);
+        }
+        std::signal(SIGINT, SIG_DFL);
+        std::signal(SIGTERM, SIG_DFL);
+    } else {
+        while (log.drain(on_line, kDrainBatch) == kDrainBatch) checkpoint_due();
+        // A finished log may end without a newline; decode that line too,
+        // unless checkpointing, where it may still be half written and is
+        // left for the next run.
+        std::string tail;
+        if (checkpoint_path.empty() && log.partial(tail)) {
+            on_line(tail.data(), tail.size());
+            log.consume_partial();
         }
     }
+    if (!checkpoint_path.empty()) save_checkpoint();
 
+    if (out_writer) {
+        if (!out_writer->close()) {
+            std::cerr << "Writing output.txt failed: " << out_writer->error() << "\n";
+            return 1;
+        }
+        const auto& ws = out_writer->stats();
+        std::cout << "Output: " << ws.bytes << " bytes via " << out_writer->backend_name()
+                  << (out_writer->direct() ? " (O_DIRECT)" : "") << ", " << std::fixed << std::setprecision(1)
+                  << ws.mib_per_s() << " MiB/s produced, " << ws.write_mib_per_s() << " MiB/s while writing, "
+                  << ws.stalls << " stalls (" << ws.stall_ns / 1e6 << " ms)\n"
+                  << std::defaultfloat;
+    } else {
+        out_file.close();
+    }
     std::cout << "Decoded to output.txt\n";
+    if (memo_enabled) {
+        memo.write_stats(std::cout);
+        std::cout << "Value text: " << text.reused() << " reused / "
+                  << text.reused() + text.rendered() << " samples\n";
+    }
+
+    if (timing) {
+        timing->finish();
+        if (!timing_path.empty()) {
+            std::ofstream rep(timing_path);
+            timing->write_report(rep);
+        }
+    }
+
+    if (history) history->write_stats(std::cout);
+
+    if (trigger) {
+        trigger->finish();
+        std::cout << "Triggers: " << trigger->fired() << " fired, " << trigger->files().size()
+                  << " captures written, " << trigger->suppressed() << " over --trigger-max\n";
+        for (const auto& f : trigger->files()) std::cout << "  " << f << "\n";
+    }
+
+    if (range) {
+        std::cout << "Range check: " << range->violations() << " of " << range->checked()
+                  << " samples out of range (" << range->limited_signals() << " signals with limits), dropped "
+                  << range->dropped() << "\n";
+        if (!range_report_path.empty()) {
+            std::ofstream rep(range_report_path);
+            range->write_summary(rep);
+        }
+    }
+
+    if (latest) {
+        std::ofstream snap(snapshot_path);
+        latest->dump(snap);
+    }
+
+    if (publisher) {
+        if (!publisher->flush()) std::cerr << "Publisher: queue not drained before exit\n";
+        const auto st = publisher->stats();
+        std::cout << "Published " << st.samples_queued - st.samples_dropped << " samples in "
+                  << st.batches_sent << " batches (" << st.bytes_sent << " bytes), dropped "
+                  << st.samples_dropped << ", connects " << st.connects << "\n";
+    }
     return 0;
 }
@@ -1,4 +1,5 @@
 #include "src/dbc_simple.hpp"
+#include "src/timestamp.hpp"
 #include <fstream>
 #include <iostream>
 #include <iomanip>
@@ -37,7 +38,7 @@ static std::string canonical_iface(const std::string& s) {
 }
 
 struct ParsedLine {
-    double ts = 0.0;
+    int64_t ts_ns = 0;
     std::string iface;
     uint32_t id = 0;
     std::vector<uint8_t> data;
@@ -50,7 +51,8 @@ static bool parse_dump_line(const std::string& line, ParsedLine& out) {
     std::smatch m;
     if (!std::regex_match(line, m, rx)) return false;
 
-    out.ts = std::stod(m[1].str());
+    const std::string ts = m[1].str();
+    if (!rbk::parse_timestamp(ts.data(), ts.data() + ts.size(), out.ts_ns)) return false;
     out.iface = canonical_iface(m[2].str());
 
     std::stringstream ss;
@@ -113,11 +115,11 @@ int main() {
         if (!parse_dump_line(line, pl)) continue;
 
         if (pl.iface == "can0") {
-            stage4::decode_frame_and_write(net0, pl.id, pl.ts, pl.data, out);
+            stage4::decode_frame_and_write(net0, pl.id, pl.ts_ns, pl.data, out);
         } else if (pl.iface == "can1") {
-            stage4::decode_frame_and_write(net1, pl.id, pl.ts, pl.data, out);
+            stage4::decode_frame_and_write(net1, pl.id, pl.ts_ns, pl.data, out);
         } else if (pl.iface == "can2") {
-            stage4::decode_frame_and_write(net2, pl.id, pl.ts, pl.data, out);
+            stage4::decode_frame_and_write(net2, pl.id, pl.ts_ns, pl.data, out);
         }
     }
 
@@ -0,0 +1,476 @@
+#include "async_writer.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__) && !defined(RBK_NO_IO_URING) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#define RBK_HAVE_IO_URING 1
+#else
+#define RBK_HAVE_IO_URING 0
+#endif
+
+namespace rbk {
+
+namespace {
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+} // namespace
+
+#if RBK_HAVE_IO_URING
+// Minimal single-producer io_uring straight on the kernel ABI (no liburing):
+// one IORING_OP_WRITEV per buffer, which every io_uring kernel (5.1+) has.
+struct AsyncFileWriter::Uring {
+    int fd = -1;
+    void* sq_ptr = MAP_FAILED;
+    size_t sq_len = 0;
+    void* cq_ptr = MAP_FAILED;
+    size_t cq_len = 0;
+    void* sqe_ptr = MAP_FAILED;
+    size_t sqe_len = 0;
+
+    unsigned* sq_tail = nullptr;
+    unsigned sq_mask = 0;
+    unsigned* sq_array = nullptr;
+    io_uring_sqe* sqes = nullptr;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned cq_mask = 0;
+    io_uring_cqe* cqes = nullptr;
+
+    std::vector<iovec> iov; // one per buffer, must outlive the request
+
+    ~Uring() {
+        if (sqe_ptr != MAP_FAILED) ::munmap(sqe_ptr, sqe_len);
+        if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) ::munmap(cq_ptr, cq_len);
+        if (sq_ptr != MAP_FAILED) ::munmap(sq_ptr, sq_len);
+        if (fd >= 0) ::close(fd);
+    }
+
+    bool init(unsigned entries) {
+        io_uring_params p{};
+        fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &p));
+        if (fd < 0) return false;
+
+        sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_len = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        const bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) sq_len = cq_len = std::max(sq_len, cq_len);
+
+        sq_ptr = ::mmap(nullptr, sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sq_ptr == MAP_FAILED) return false;
+        cq_ptr = single ? sq_ptr
+                        : ::mmap(nullptr, cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                                 IORING_OFF_CQ_RING);
+        if (cq_ptr == MAP_FAILED) return false;
+        sqe_len = p.sq_entries * sizeof(io_uring_sqe);
+        sqe_ptr = ::mmap(nullptr, sqe_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (sqe_ptr == MAP_FAILED) return false;
+
+        char* sq = static_cast<char*>(sq_ptr);
+        sq_tail = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sq_mask = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        sqes = static_cast<io_uring_sqe*>(sqe_ptr);
+
+        char* cq = static_cast<char*>(cq_ptr);
+        cq_head = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+        return true;
+    }
+
+    bool submit(int file, unsigned idx, char* data, size_t len, uint64_t off) {
+        const unsigned tail = *sq_tail; // only we advance it
+        const unsigned slot = tail & sq_mask;
+        iov[idx].iov_base = data;
+        iov[idx].iov_len = len;
+
+        io_uring_sqe& e = sqes[slot];
+        std::memset(&e, 0, sizeof(e));
+        e.opcode = IORING_OP_WRITEV;
+        e.fd = file;
+        e.addr = reinterpret_cast<uint64_t>(&iov[idx]);
+        e.len = 1;
+        e.off = off;
+        e.user_data = idx;
+        sq_array[slot] = slot;
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+        // GETEVENTS with min_complete 0 also posts finished writes still
+        // queued as task work, so the next peek sees them; it never waits.
+        for (;;) {
+            const long r = ::syscall(__NR_io_uring_enter, fd, 1, 0, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (r >= 0) return true;
+            if (errno != EINTR) return false;
+        }
+    }
+
+    // Have the kernel post pending completions without waiting for any.
+    bool get_events() {
+        for (;;) {
+            if (::syscall(__NR_io_uring_enter, fd, 0, 0, IORING_ENTER_GETEVENTS, nullptr, 0) >= 0) return true;
+            if (errno != EINTR) return false;
+        }
+    }
+
+    // Next completion. Without `wait`, false means none ready; with it,
+    // false means io_uring_enter failed (errno set).
+    bool pop(io_uring_cqe& out, bool wait) {
+        for (;;) {
+            const unsigned head = *cq_head;
+            if (head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+                out = cqes[head & cq_mask];
+                __atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+            if (!wait) return false;
+            if (::syscall(__NR_io_uring_enter, fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR) {
+                return false;
+            }
+        }
+    }
+};
+#else
+struct AsyncFileWriter::Uring {};
+#endif
+
+AsyncFileWriter::AsyncFileWriter(const std::string& path, WriterConfig cfg) : cfg_(cfg) {
+    cfg_.buffers = std::max(2u, cfg_.buffers);
+    cfg_.buffer_bytes = std::max(kDirectAlign, (cfg_.buffer_bytes + kDirectAlign - 1) / kDirectAlign * kDirectAlign);
+    setp(nullptr, nullptr);
+
+    const bool resume = cfg_.resume_offset >= 0;
+    const int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (resume ? 0 : O_TRUNC);
+#ifdef O_DIRECT
+    // A resumed file generally ends mid-block, which O_DIRECT cannot append to.
+    if (cfg_.direct && !resume) {
+        fd_ = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        direct_ = fd_ >= 0;
+    }
+#endif
+    if (fd_ < 0) fd_ = ::open(path.c_str(), flags, 0644);
+    if (fd_ < 0) {
+        fail("open " + path, errno);
+        return;
+    }
+    if (resume) {
+        if (::ftruncate(fd_, static_cast<off_t>(cfg_.resume_offset)) != 0) {
+            fail("ftruncate " + path, errno);
+            return;
+        }
+        offset_ = static_cast<uint64_t>(cfg_.resume_offset);
+    }
+
+    bufs_.resize(cfg_.buffers);
+    for (auto& b : bufs_) {
+        b.data = static_cast<char*>(std::aligned_alloc(kDirectAlign, cfg_.buffer_bytes));
+        if (!b.data) {
+            fail("buffer allocation", ENOMEM);
+            return;
+        }
+    }
+
+#if RBK_HAVE_IO_URING
+    if (cfg_.backend != WriterBackend::Thread) {
+        uring_.reset(new Uring);
+        uring_->iov.resize(cfg_.buffers);
+        if (!uring_->init(cfg_.buffers)) uring_.reset(); // e.g. blocked by seccomp
+    }
+#endif
+    if (cfg_.backend == WriterBackend::IoUring && !uring_) {
+        fail("io_uring", ENOSYS);
+        return;
+    }
+
+    if (uring_) {
+        for (unsigned i = 1; i < cfg_.buffers; ++i) free_.push_back(i);
+    } else {
+        for (unsigned i = 1; i < cfg_.buffers; ++i) returned_.push_back(i);
+        thread_ = std::thread(&AsyncFileWriter::worker, this);
+    }
+
+    current_ = 0;
+    setp(bufs_[0].data, bufs_[0].data + cfg_.buffer_bytes);
+    open_ns_ = now_ns();
+}
+
+AsyncFileWriter::~AsyncFileWriter() {
+    close();
+    uring_.reset();
+    for (auto& b : bufs_) std::free(b.data);
+}
+
+const char* AsyncFileWriter::backend_name() const {
+    return uring_ ? "io_uring" : "pwrite thread";
+}
+
+void AsyncFileWriter::fail(const std::string& what, int err) {
+    if (err_.empty()) err_ = what + ": " + std::strerror(err);
+}
+
+AsyncFileWriter::int_type AsyncFileWriter::overflow(int_type ch) {
+    if (fd_ < 0 || !ok() || !pbase()) return traits_type::eof();
+    if (pptr() == epptr()) {
+        if (!submit_current(static_cast<size_t>(pptr() - pbase())) || !acquire_buffer()) {
+            setp(nullptr, nullptr);
+            return traits_type::eof();
+        }
+    }
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize AsyncFileWriter::xsputn(const char* s, std::streamsize n) {
+    std::streamsize done = 0;
+    while (done < n) {
+        if (pptr() == epptr() && traits_type::eq_int_type(overflow(traits_type::eof()), traits_type::eof())) break;
+        const size_t k = std::min(static_cast<size_t>(epptr() - pptr()), static_cast<size_t>(n - done));
+        std::memcpy(pptr(), s + done, k);
+        pbump(static_cast<int>(k));
+        done += static_cast<std::streamsize>(k);
+    }
+    return done;
+}
+
+bool AsyncFileWriter::submit_current(size_t used) {
+    if (used == 0) return true;
+    Buffer& b = bufs_[current_];
+
+    // Only the final buffer can be partial; under O_DIRECT pad it to the
+    // block size and trim the file back in close().
+    size_t len = used;
+    if (direct_ && len % kDirectAlign) {
+        const size_t padded = (len + kDirectAlign - 1) / kDirectAlign * kDirectAlign;
+        std::memset(b.data + len, 0, padded - len);
+        len = padded;
+    }
+    b.len = len;
+    b.done = 0;
+    b.offset = offset_;
+    offset_ += used;
+    stats_.bytes += used;
+    ++stats_.submits;
+
+    if (uring_) {
+        if (!uring_submit(current_)) return false;
+        if (in_flight_++ == 0) busy_since_ns_ = now_ns();
+        return true;
+    }
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        queue_.push_back(current_);
+    }
+    cv_.notify_all();
+    return true;
+}
+
+bool AsyncFileWriter::acquire_buffer() {
+    const int64_t t0 = now_ns();
+    bool stalled = false;
+    if (uring_) {
+        if (!uring_reap(false)) return false;
+        if (free_.empty()) {
+            // Only block if nothing has finished that the kernel has yet
+            // to post to the completion ring.
+            if (!uring_get_events() || !uring_reap(false)) return false;
+        }
+        while (free_.empty()) {
+            stalled = true;
+            if (!uring_reap(true)) return false;
+        }
+        current_ = free_.back();
+        free_.pop_back();
+    } else {
+        std::unique_lock<std::mutex> lk(mu_);
+        stalled = returned_.empty();
+        cv_.wait(lk, [&] { return !returned_.empty() || thread_err_ != 0; });
+        if (thread_err_) {
+            const int err = thread_err_;
+            lk.unlock();
+            fail("write", err);
+            return false;
+        }
+        current_ = returned_.front();
+        returned_.pop_front();
+    }
+    if (stalled) {
+        ++stats_.stalls;
+        stats_.stall_ns += static_cast<uint64_t>(now_ns() - t0);
+    }
+    setp(bufs_[current_].data, bufs_[current_].data + cfg_.buffer_bytes);
+    return true;
+}
+
+bool AsyncFileWriter::uring_submit(unsigned idx) {
+#if RBK_HAVE_IO_URING
+    Buffer& b = bufs_[idx];
+    if (!uring_->submit(fd_, idx, b.data + b.done, b.len - b.done, b.offset + b.done)) {
+        fail("io_uring_enter", errno);
+        return false;
+    }
+    return true;
+#else
+    (void)idx;
+    return false;
+#endif
+}
+
+bool AsyncFileWriter::uring_get_events() {
+#if RBK_HAVE_IO_URING
+    if (in_flight_ == 0 || uring_->get_events()) return true;
+    fail("io_uring_enter", errno);
+    return false;
+#else
+    return false;
+#endif
+}
+
+// Collect finished writes into free_. With `wait`, block for at least one.
+bool AsyncFileWriter::uring_reap(bool wait) {
+#if RBK_HAVE_IO_URING
+    while (in_flight_ > 0) {
+        io_uring_cqe cqe;
+        if (!uring_->pop(cqe, wait)) {
+            if (!wait) return true;
+            fail("io_uring_enter", errno);
+            return false;
+        }
+        wait = false;
+        --in_flight_;
+
+        const unsigned idx = static_cast<unsigned>(cqe.user_data);
+        Buffer& b = bufs_[idx];
+        if (cqe.res <= 0) {
+            fail("write", cqe.res < 0 ? -cqe.res : EIO);
+            return false;
+        }
+        b.done += static_cast<size_t>(cqe.res);
+        if (b.done < b.len) { // short write: queue the rest
+            if (!uring_submit(idx)) return false;
+            ++in_flight_;
+            continue;
+        }
+        free_.push_back(idx);
+        if (in_flight_ == 0) stats_.busy_ns += static_cast<uint64_t>(now_ns() - busy_since_ns_);
+    }
+    return true;
+#else
+    (void)wait;
+    return false;
+#endif
+}
+
+void AsyncFileWriter::worker() {
+    for (;;) {
+        unsigned idx;
+        {
+            std::unique_lock<std::mutex> lk(mu_);
+            cv_.wait(lk, [&] { return stop_ || !queue_.empty(); });
+            if (queue_.empty()) return; // stop_ and drained
+            idx = queue_.front();
+            queue_.pop_front();
+        }
+
+        Buffer& b = bufs_[idx];
+        const int64_t t0 = now_ns();
+        int err = 0;
+        while (b.done < b.len) {
+            const ssize_t r = ::pwrite(fd_, b.data + b.done, b.len - b.done, static_cast<off_t>(b.offset + b.done));
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                err = errno;
+                break;
+            }
+            if (r == 0) {
+                err = EIO;
+                break;
+            }
+            b.done += static_cast<size_t>(r);
+        }
+        const int64_t t = now_ns();
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            if (err && !thread_err_) thread_err_ = err;
+            thread_busy_ns_ += static_cast<uint64_t>(t - t0);
+            returned_.push_back(idx);
+        }
+        cv_.notify_all();
+    }
+}
+
+bool AsyncFileWriter::wait_idle() {
+    if (uring_) {
+        while (in_flight_ > 0) {
+            if (!uring_reap(true)) return false;
+        }
+        return true;
+    }
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_.wait(lk, [&] { return returned_.size() == bufs_.size() || thread_err_ != 0; });
+    if (thread_err_) {
+        const int err = thread_err_;
+        lk.unlock();
+        fail("write", err);
+        return false;
+    }
+    return true;
+}
+
+bool AsyncFileWriter::flush() {
+    if (fd_ < 0 || !ok() || !pbase() || direct_) return ok();
+    const size_t used = static_cast<size_t>(pptr() - pbase());
+    if (used == 0) return true;
+    if (!submit_current(used) || !wait_idle() || !acquire_buffer()) {
+        setp(nullptr, nullptr);
+        return false;
+    }
+    return true;
+}
+
+bool AsyncFileWriter::close() {
+    if (fd_ < 0) return ok();
+
+    if (ok() && pbase()) submit_current(static_cast<size_t>(pptr() - pbase()));
+    setp(nullptr, nullptr);
+
+    if (uring_) {
+        while (in_flight_ > 0 && uring_reap(true)) {
+        }
+    } else if (thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+        if (thread_err_) fail("write", thread_err_);
+        stats_.busy_ns = thread_busy_ns_;
+    }
+
+    if (direct_ && ::ftruncate(fd_, static_cast<off_t>(offset_)) != 0) fail("ftruncate", errno);
+    if (::close(fd_) != 0) fail("close", errno);
+    fd_ = -1;
+    stats_.elapsed_ns = now_ns() - open_ns_;
+    return ok();
+}
+
+} // namespace rbk
@@ -0,0 +1,146 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rbk {
+
+enum class WriterBackend { Auto, IoUring, Thread };
+
+struct WriterConfig {
+    size_t buffer_bytes = 1u << 20;  // rounded up to kDirectAlign
+    unsigned buffers = 4;            // one filling, the rest in flight
+    bool direct = false;             // O_DIRECT; silently dropped if the fs refuses it
+    int64_t resume_offset = -1;      // >= 0: keep the file, cut it to this size and append
+    WriterBackend backend = WriterBackend::Auto;
+};
+
+struct WriterStats {
+    uint64_t bytes = 0;        // logical bytes written
+    uint64_t submits = 0;      // buffers handed to the backend
+    uint64_t stalls = 0;       // times the producer waited for a free buffer
+    uint64_t stall_ns = 0;
+    uint64_t busy_ns = 0;      // time with at least one write outstanding
+    int64_t elapsed_ns = 0;    // open -> close
+
+    // Rate the producer generated output at (bounded by decode speed).
+    double mib_per_s() const { return rate(elapsed_ns); }
+    // Rate while the disk had work: the sustained write bandwidth when the
+    // disk is the bottleneck. Completions are noticed lazily, so this is a
+    // lower bound.
+    double write_mib_per_s() const { return rate(static_cast<int64_t>(busy_ns)); }
+
+private:
+    double rate(int64_t ns) const {
+        return ns > 0 ? static_cast<double>(bytes) / (1024.0 * 1024.0) / (static_cast<double>(ns) / 1e9) : 0.0;
+    }
+};
+
+// Buffer alignment and size granularity (O_DIRECT needs logical-block
+// alignment; 4 KiB covers every NVMe/SSD we run on).
+constexpr size_t kDirectAlign = 4096;
+
+// Output file behind a std::ostream. The producer writes straight into one
+// of a pool of aligned buffers; full buffers are written in the background
+// via io_uring (when the kernel allows it) or a pwrite() thread, overlapping
+// at most `buffers - 1` buffers of output with production.
+//
+// There is no completion thread: io_uring completions are collected on the
+// producer's thread whenever it submits a buffer or needs a free one (first
+// without waiting, including completions the kernel has not yet posted).
+// When every buffer is still in flight the producer blocks until one is
+// written, so a disk slower than the producer sets the producer's pace;
+// stats() counts those stalls.
+//
+//   AsyncFileWriter w("output.txt", cfg);
+//   std::ostream os(&w);
+//   ...
+//   w.close();
+class AsyncFileWriter : public std::streambuf {
+public:
+    AsyncFileWriter(const std::string& path, WriterConfig cfg);
+    ~AsyncFileWriter() override;
+
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    bool ok() const { return err_.empty(); }
+    const std::string& error() const { return err_; }
+
+    // Write the last partial buffer, wait for every write and close the file.
+    // Returns false if any write failed.
+    bool close();
+
+    // Push out everything buffered so far and wait for it to reach the file
+    // (for live output and checkpoints). Not available under O_DIRECT, where
+    // only whole blocks can be written: buffered bytes then stay buffered.
+    bool flush();
+
+    // File length once everything handed to the writer has been written.
+    uint64_t size() const { return offset_ + (pbase() ? static_cast<uint64_t>(pptr() - pbase()) : 0); }
+    // Bytes already handed to the backend (== size() right after flush()).
+    uint64_t submitted() const { return offset_; }
+
+    const WriterStats& stats() const { return stats_; }
+    const char* backend_name() const;
+    bool direct() const { return direct_; }
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+    // Flushing a stream does not force a partial (unaligned) buffer out.
+    int sync() override { return 0; }
+
+private:
+    struct Buffer {
+        char* data = nullptr;
+        size_t len = 0;         // bytes to write (padded under O_DIRECT)
+        size_t done = 0;        // bytes already written (short writes)
+        uint64_t offset = 0;
+    };
+    struct Uring;
+
+    bool submit_current(size_t used);
+    bool acquire_buffer();
+    bool wait_idle();
+    void fail(const std::string& what, int err);
+
+    // io_uring backend
+    bool uring_submit(unsigned idx);
+    bool uring_reap(bool wait);
+    bool uring_get_events();
+    // thread backend
+    void worker();
+
+    WriterConfig cfg_;
+    std::string err_;
+    int fd_ = -1;
+    bool direct_ = false;
+    std::vector<Buffer> bufs_;
+    std::vector<unsigned> free_;    // producer-owned free list (io_uring)
+    unsigned current_ = 0;
+    unsigned in_flight_ = 0;
+    uint64_t offset_ = 0;
+    int64_t open_ns_ = 0;
+    int64_t busy_since_ns_ = 0;  // io_uring: when in_flight_ last left 0
+    WriterStats stats_;
+
+    std::unique_ptr<Uring> uring_;
+
+    std::thread thread_;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::deque<unsigned> queue_;     // filled, waiting for the writer thread
+    std::deque<unsigned> returned_;  // written, back to the producer
+    bool stop_ = false;
+    int thread_err_ = 0;
+    uint64_t thread_busy_ns_ = 0;
+};
+
+} // namespace rbk
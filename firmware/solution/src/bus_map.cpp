@@ -0,0 +1,118 @@
+#include "bus_map.hpp"
+#include <fstream>
+#include <sstream>
+
+namespace rbk {
+
+bool BusMap::add(BusConfig bus, std::string* err) {
+    auto bad = [&](const std::string& why) {
+        if (err) *err = why;
+        return false;
+    };
+    if (buses_.size() >= kMaxBuses) return bad("too many buses");
+
+    std::vector<std::string> names;
+    names.push_back(bus.name);
+    names.insert(names.end(), bus.aliases.begin(), bus.aliases.end());
+    for (size_t i = 0; i < names.size(); ++i) {
+        const std::string& n = names[i];
+        if (n.empty() || n.size() > kMaxIfaceLen) return bad("bad interface name '" + n + "'");
+        if (lookup(n) != kNoBus) return bad("interface '" + n + "' mapped twice");
+        for (size_t j = 0; j < i; ++j) {
+            if (names[j] == n) return bad("interface '" + n + "' mapped twice");
+        }
+    }
+
+    buses_.push_back(std::move(bus));
+    rebuild();
+    return true;
+}
+
+void BusMap::rebuild() {
+    struct Name {
+        const std::string* s;
+        uint8_t bus;
+    };
+    std::vector<Name> names;
+    for (size_t b = 0; b < buses_.size(); ++b) {
+        names.push_back({&buses_[b].name, static_cast<uint8_t>(b)});
+        for (const auto& a : buses_[b].aliases) names.push_back({&a, static_cast<uint8_t>(b)});
+    }
+
+    // Table at least 2x the name count; search seeds until nothing collides,
+    // growing the table if a size turns out unlucky.
+    size_t size = 8;
+    while (size < names.size() * 2) size <<= 1;
+    for (;;) {
+        for (uint32_t seed = 0; seed < 256; ++seed) {
+            std::vector<Slot> table(size);
+            bool ok = true;
+            for (const Name& n : names) {
+                Slot& slot = table[hash(n.s->data(), n.s->size(), seed) & (size - 1)];
+                if (slot.len != 0) {
+                    ok = false;
+                    break;
+                }
+                slot.len = static_cast<uint8_t>(n.s->size());
+                slot.bus = n.bus;
+                std::memcpy(slot.name, n.s->data(), n.s->size());
+            }
+            if (ok) {
+                table_ = std::move(table);
+                seed_ = seed;
+                mask_ = static_cast<uint32_t>(size - 1);
+                return;
+            }
+        }
+        size <<= 1;
+    }
+}
+
+bool BusMap::load(const std::string& path, std::string* err) {
+    std::ifstream is(path);
+    if (!is) {
+        if (err) *err = "cannot open " + path;
+        return false;
+    }
+    std::string line;
+    size_t lineno = 0;
+    while (std::getline(is, line)) {
+        ++lineno;
+        const auto hash_pos = line.find('#');
+        if (hash_pos != std::string::npos) line.erase(hash_pos);
+
+        std::istringstream ls(line);
+        BusConfig bus;
+        if (!(ls >> bus.name)) continue; // blank / comment
+        if (!(ls >> bus.dbc)) {
+            if (err) *err = path + ":" + std::to_string(lineno) + ": missing DBC file for " + bus.name;
+            return false;
+        }
+        std::string alias;
+        while (ls >> alias) bus.aliases.push_back(alias);
+
+        std::string why;
+        if (!add(std::move(bus), &why)) {
+            if (err) *err = path + ":" + std::to_string(lineno) + ": " + why;
+            return false;
+        }
+    }
+    if (buses_.empty()) {
+        if (err) *err = path + ": no buses";
+        return false;
+    }
+    return true;
+}
+
+const BusMap& BusMap::builtin() {
+    static const BusMap map = [] {
+        BusMap m;
+        m.add({"can0", "dbc-files/ControlBus.dbc", {"vcan0"}});
+        m.add({"can1", "dbc-files/SensorBus.dbc", {"vcan1"}});
+        m.add({"can2", "dbc-files/TractiveBus.dbc", {"vcan2"}});
+        return m;
+    }();
+    return map;
+}
+
+} // namespace rbk
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace rbk {
+
+constexpr uint8_t kNoBus = 0xFF;       // interface not in the map
+constexpr size_t kMaxIfaceLen = 15;    // IFNAMSIZ - 1
+constexpr size_t kMaxBuses = 254;
+
+// One bus: primary interface name, the DBC decoded on it and any other
+// interface names that carry the same bus (e.g. vcan0 for can0).
+struct BusConfig {
+    std::string name;
+    std::string dbc;
+    std::vector<std::string> aliases;
+};
+
+// Interface name -> bus index. Bus indices follow add() order and index
+// every per-bus table (SignalCatalog, BusTiming, shm rings).
+//
+// lookup() is a seeded FNV-1a over the name into a collision-free table
+// (the seed is searched when buses are added) followed by one length check
+// and memcmp: constant cost whatever the bus count, and no allocation.
+class BusMap {
+public:
+    // Register a bus; false if a name is empty, too long or already used.
+    bool add(BusConfig bus, std::string* err = nullptr);
+
+    // Config file: one bus per line, "<interface> <dbc-file> [alias ...]".
+    // '#' starts a comment. DBC paths are used as written (relative to the
+    // working directory, like the built-in defaults).
+    bool load(const std::string& path, std::string* err = nullptr);
+
+    // can0/vcan0 ControlBus, can1/vcan1 SensorBus, can2/vcan2 TractiveBus.
+    static const BusMap& builtin();
+
+    size_t size() const { return buses_.size(); }
+    const BusConfig& bus(uint8_t index) const { return buses_[index]; }
+
+    uint8_t lookup(const char* s, size_t n) const {
+        if (n == 0 || n > kMaxIfaceLen || table_.empty()) return kNoBus;
+        const Slot& slot = table_[hash(s, n, seed_) & mask_];
+        return (slot.len == n && std::memcmp(slot.name, s, n) == 0) ? slot.bus : kNoBus;
+    }
+    uint8_t lookup(const std::string& s) const { return lookup(s.data(), s.size()); }
+
+private:
+    struct Slot {
+        uint8_t len = 0;
+        uint8_t bus = kNoBus;
+        char name[kMaxIfaceLen + 1] = {};
+    };
+
+    static uint32_t hash(const char* s, size_t n, uint32_t seed) {
+        uint32_t h = 2166136261u ^ seed;
+        for (size_t i = 0; i < n; ++i) {
+            h ^= static_cast<unsigned char>(s[i]);
+            h *= 16777619u;
+        }
+        return h ^ (h >> 15);
+    }
+
+    void rebuild();
+
+    std::vector<BusConfig> buses_;
+    std::vector<Slot> table_;
+    uint32_t seed_ = 0;
+    uint32_t mask_ = 0;
+};
+
+} // namespace rbk
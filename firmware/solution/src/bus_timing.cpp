@@ -0,0 +1,305 @@
+#include "bus_timing.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <istream>
+#include <string>
+
+namespace rbk {
+
+const char* to_string(TimingAlert::Kind k) {
+    switch (k) {
+        case TimingAlert::Kind::Late:    return "LATE";
+        case TimingAlert::Kind::Missing: return "MISSING";
+        case TimingAlert::Kind::BusLoad: return "BUSLOAD";
+    }
+    return "?";
+}
+
+double IdTiming::jitter_ns() const {
+    return frames > 2 ? std::sqrt(gap_m2 / static_cast<double>(frames - 2)) : 0.0;
+}
+
+BusTiming::BusTiming(TimingConfig cfg) : cfg_(cfg) {}
+
+uint32_t BusTiming::frame_bits(uint32_t can_id, size_t dlc) {
+    const bool extended = (can_id & 0x80000000u) || (can_id & 0x1FFFFFFFu) > 0x7FF;
+    const uint32_t n = static_cast<uint32_t>(std::min<size_t>(dlc, 8));
+    // SOF..IFS: 47 bits standard, 67 bits extended, plus the data field
+    return (extended ? 67u : 47u) + 8u * n;
+}
+
+BusLoad& BusTiming::bus(uint8_t b) {
+    if (b >= buses_.size()) {
+        buses_.resize(static_cast<size_t>(b) + 1);
+        for (auto& bl : buses_) {
+            if (!bl.bitrate) bl.bitrate = cfg_.bitrate;
+        }
+    }
+    return buses_[b];
+}
+
+IdTiming& BusTiming::slot(uint8_t b, uint32_t can_id) {
+    const uint64_t key = (static_cast<uint64_t>(b) << 32) | can_id;
+    auto it = index_.find(key);
+    if (it != index_.end()) return ids_[it->second];
+    index_.emplace(key, static_cast<uint32_t>(ids_.size()));
+    ids_.emplace_back();
+    ids_.back().bus = b;
+    ids_.back().can_id = can_id;
+    return ids_.back();
+}
+
+void BusTiming::declare(uint8_t b, uint32_t can_id, const std::string& name, uint32_t cycle_ms) {
+    bus(b);
+    IdTiming& t = slot(b, can_id);
+    t.name = name;
+    t.cycle_ms = cycle_ms;
+}
+
+void BusTiming::declare_network(uint8_t b, const dbcppp::INetwork& net) {
+    for (const dbcppp::IMessage& msg : net.Messages()) {
+        declare(b, static_cast<uint32_t>(msg.Id()), msg.Name(), cycle_time_ms(msg));
+    }
+}
+
+void BusTiming::raise(const TimingAlert& a) {
+    if (alert_) alert_(a);
+}
+
+void BusTiming::close_window(uint8_t b) {
+    BusLoad& bl = buses_[b];
+    const double secs = static_cast<double>(cfg_.load_window_ns) / 1e9;
+    const double load = static_cast<double>(bl.window_bits) / (static_cast<double>(bl.bitrate) * secs);
+    bl.peak = std::max(bl.peak, load);
+    bl.sum += load;
+    bl.windows++;
+    bl.window_bits = 0;
+    bl.window_start_ns += cfg_.load_window_ns;
+
+    if (load > cfg_.load_alert) {
+        TimingAlert a;
+        a.kind = TimingAlert::Kind::BusLoad;
+        a.bus = b;
+        a.ts_ns = bl.window_start_ns;
+        a.load = load;
+        raise(a);
+    }
+}
+
+void BusTiming::check_missing(IdTiming& t, int64_t now_ns) {
+    // Periodic IDs that have gone quiet. Only ones seen at least once: an ID
+    // that never appears in the log is reported, not alerted on.
+    if (!t.cycle_ms || !t.frames || t.stale) return;
+    const int64_t gap = now_ns - t.last_ns;
+    if (static_cast<double>(gap) > cfg_.late_factor * t.cycle_ms * 1e6) {
+        t.stale = true;
+        TimingAlert a;
+        a.kind = TimingAlert::Kind::Missing;
+        a.bus = t.bus;
+        a.can_id = t.can_id;
+        a.ts_ns = now_ns;
+        a.gap_ns = gap;
+        a.id = &t;
+        raise(a);
+    }
+}
+
+void BusTiming::scan_missing(uint8_t b, int64_t now_ns) {
+    for (IdTiming& t : ids_) {
+        if (t.bus == b) check_missing(t, now_ns);
+    }
+}
+
+void BusTiming::tick(int64_t now_ns) {
+    for (IdTiming& t : ids_) check_missing(t, now_ns);
+}
+
+void BusTiming::observe(uint8_t b, const ParsedLine& pl) {
+    BusLoad& bl = bus(b);
+    const int64_t now = pl.ts_ns;
+
+    if (bl.frames == 0) bl.window_start_ns = now;
+    const bool closed = now - bl.window_start_ns >= cfg_.load_window_ns;
+    if (closed) {
+        close_window(b);
+        // skip over idle stretches without looping window by window
+        const int64_t idle = (now - bl.window_start_ns) / cfg_.load_window_ns;
+        if (idle > 0) {
+            bl.windows += static_cast<uint64_t>(idle);
+            bl.window_start_ns += idle * cfg_.load_window_ns;
+        }
+    }
+
+    const uint32_t bits = frame_bits(pl.can_id, pl.data.size());
+    bl.window_bits += bits;
+    bl.total_bits += bits;
+    bl.frames++;
+    bl.last_ns = now;
+
+    IdTiming& t = slot(b, pl.can_id);
+    if (t.frames == 0) {
+        t.first_ns = now;
+    } else {
+        const int64_t gap = std::max<int64_t>(0, now - t.last_ns); // tolerate reordering
+        const uint64_t n = t.frames; // gaps seen so far incl. this one
+        const double d = static_cast<double>(gap) - t.gap_mean_ns;
+        t.gap_mean_ns += d / static_cast<double>(n);
+        t.gap_m2 += d * (static_cast<double>(gap) - t.gap_mean_ns);
+        if (n == 1 || gap < t.min_gap_ns) t.min_gap_ns = gap;
+        if (gap > t.max_gap_ns) t.max_gap_ns = gap;
+
+        const int64_t us = gap / 1000;
+        size_t bin = 0;
+        if (us > 0) bin = std::min<size_t>(kGapBins - 1, 64 - static_cast<size_t>(__builtin_clzll(static_cast<uint64_t>(us))));
+        t.hist[bin]++;
+
+        if (t.cycle_ms) {
+            const double cycle_ns = t.cycle_ms * 1e6;
+            if (static_cast<double>(gap) > cfg_.late_factor * cycle_ns) {
+                t.late++;
+                const int64_t lost = std::llround(static_cast<double>(gap) / cycle_ns) - 1;
+                if (lost > 0) t.missed += static_cast<uint64_t>(lost);
+                if (t.last_alert_ns == 0 || now - t.last_alert_ns >= cfg_.alert_holdoff_ns) {
+                    t.last_alert_ns = now;
+                    TimingAlert a;
+                    a.kind = TimingAlert::Kind::Late;
+                    a.bus = b;
+                    a.can_id = pl.can_id;
+                    a.ts_ns = now;
+                    a.gap_ns = gap;
+                    a.id = &t;
+                    raise(a);
+                }
+            }
+        }
+    }
+    t.stale = false;
+    t.last_ns = now;
+    t.frames++;
+
+    // after this frame's own update, so it is never reported as missing
+    if (closed) scan_missing(b, now);
+}
+
+void BusTiming::finish() {
+    int64_t newest = 0;
+    for (const auto& bl : buses_) {
+        if (bl.frames) newest = std::max(newest, bl.last_ns);
+    }
+    if (newest) tick(newest);
+
+    for (auto& bl : buses_) {
+        if (bl.window_bits == 0) continue;
+        // Partial last window: measure it over the time it actually covered,
+        // unless it is too short to say anything meaningful.
+        const int64_t span = bl.last_ns - bl.window_start_ns;
+        if (span >= cfg_.load_window_ns / 10) {
+            const double load = static_cast<double>(bl.window_bits) /
+                                (static_cast<double>(bl.bitrate) * static_cast<double>(span) / 1e9);
+            bl.peak = std::max(bl.peak, load);
+            bl.sum += load;
+            bl.windows++;
+        }
+        bl.window_bits = 0;
+    }
+}
+
+void BusTiming::write_report(std::ostream& os) const {
+    std::vector<const IdTiming*> rows;
+    rows.reserve(ids_.size());
+    for (const auto& t : ids_) rows.push_back(&t);
+    std::sort(rows.begin(), rows.end(), [](const IdTiming* a, const IdTiming* b) {
+        return a->bus != b->bus ? a->bus < b->bus : a->can_id < b->can_id;
+    });
+
+    char buf[256];
+    std::snprintf(buf, sizeof(buf), "%-3s %-10s %-32s %6s %9s %9s %9s %9s %9s %7s %7s\n",
+                  "bus", "id", "name", "cycle", "frames", "mean_ms", "jitter_ms", "min_ms",
+                  "max_ms", "late", "missed");
+    os << buf;
+    for (const IdTiming* t : rows) {
+        if (!t->frames && !t->cycle_ms) continue; // silent and aperiodic: nothing to say
+        std::snprintf(buf, sizeof(buf), "%-3u 0x%-8X %-32.32s %6u %9llu %9.3f %9.3f %9.3f %9.3f %7llu %7llu\n",
+                      static_cast<unsigned>(t->bus), t->can_id,
+                      t->name.empty() ? "(not in DBC)" : t->name.c_str(), t->cycle_ms,
+                      static_cast<unsigned long long>(t->frames), t->gap_mean_ns / 1e6,
+                      t->jitter_ns() / 1e6, static_cast<double>(t->min_gap_ns) / 1e6,
+                      static_cast<double>(t->max_gap_ns) / 1e6,
+                      static_cast<unsigned long long>(t->late),
+                      static_cast<unsigned long long>(t->missed));
+        os << buf;
+    }
+    for (size_t b = 0; b < buses_.size(); ++b) {
+        const BusLoad& bl = buses_[b];
+        std::snprintf(buf, sizeof(buf), "bus %zu load: mean %.1f%% peak %.1f%% (%llu frames, %u bit/s)\n",
+                      b, bl.windows ? 100.0 * bl.sum / static_cast<double>(bl.windows) : 0.0,
+                      100.0 * bl.peak, static_cast<unsigned long long>(bl.frames), bl.bitrate);
+        os << buf;
+    }
+}
+
+void BusTiming::save_state(std::ostream& os) const {
+    os << "ids " << ids_.size() << "\n";
+    for (const IdTiming& t : ids_) {
+        os << unsigned(t.bus) << ' ' << t.can_id << ' ' << t.frames << ' ' << t.first_ns << ' ' << t.last_ns << ' '
+           << t.min_gap_ns << ' ' << t.max_gap_ns << ' ';
+        put_double(os, t.gap_mean_ns);
+        os << ' ';
+        put_double(os, t.gap_m2);
+        os << ' ' << t.late << ' ' << t.missed << ' ' << t.last_alert_ns << ' ' << int(t.stale);
+        for (uint32_t h : t.hist) os << ' ' << h;
+        os << "\n";
+    }
+    os << "buses " << buses_.size() << "\n";
+    for (const BusLoad& bl : buses_) {
+        os << bl.bitrate << ' ' << bl.window_start_ns << ' ' << bl.last_ns << ' ' << bl.window_bits << ' '
+           << bl.total_bits << ' ' << bl.frames << ' ' << bl.windows << ' ';
+        put_double(os, bl.peak);
+        os << ' ';
+        put_double(os, bl.sum);
+        os << "\n";
+    }
+}
+
+bool BusTiming::load_state(std::istream& is) {
+    // Parse everything first so a damaged section leaves this untouched.
+    std::string tag;
+    size_t n = 0;
+    if (!(is >> tag >> n) || tag != "ids" || n > (1u << 24)) return false;
+    std::vector<IdTiming> ids(n);
+    for (IdTiming& t : ids) {
+        unsigned b = 0;
+        int stale = 0;
+        is >> b >> t.can_id >> t.frames >> t.first_ns >> t.last_ns >> t.min_gap_ns >> t.max_gap_ns;
+        get_double(is, t.gap_mean_ns);
+        get_double(is, t.gap_m2);
+        is >> t.late >> t.missed >> t.last_alert_ns >> stale;
+        for (uint32_t& h : t.hist) is >> h;
+        if (!is || b >= kNoBus) return false;
+        t.bus = static_cast<uint8_t>(b);
+        t.stale = stale != 0;
+    }
+    if (!(is >> tag >> n) || tag != "buses" || n > kMaxBuses) return false;
+    std::vector<BusLoad> buses(n);
+    for (BusLoad& bl : buses) {
+        is >> bl.bitrate >> bl.window_start_ns >> bl.last_ns >> bl.window_bits >> bl.total_bits >> bl.frames
+           >> bl.windows;
+        get_double(is, bl.peak);
+        get_double(is, bl.sum);
+        if (!is) return false;
+    }
+
+    for (const IdTiming& saved : ids) {
+        IdTiming& t = slot(saved.bus, saved.can_id);
+        const std::string name = t.name;
+        const uint32_t cycle = t.cycle_ms;
+        t = saved;
+        t.name = name;
+        t.cycle_ms = cycle;
+    }
+    for (size_t b = 0; b < buses.size(); ++b) bus(static_cast<uint8_t>(b)) = buses[b];
+    return true;
+}
+
+} // namespace rbk
@@ -0,0 +1,131 @@
+#pragma once
+#include "can_decode.hpp"
+#include "checkpoint.hpp"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rbk {
+
+struct TimingConfig {
+    uint32_t bitrate = 500000;        // per bus, bits/s (CAN 2.0 nominal)
+    double late_factor = 1.5;         // gap > late_factor * cycle => late frame
+    int64_t load_window_ns = 1000000000LL;
+    double load_alert = 0.80;         // alert when a window's bus load exceeds this
+    int64_t alert_holdoff_ns = 1000000000LL; // per-ID alert rate limit
+};
+
+// log2 histogram of inter-arrival gaps: bin k holds gaps in [2^(k-1), 2^k) us,
+// bin 0 is < 1 us, the last bin is everything >= 2^(kGapBins-2) us (~8.4 s).
+constexpr size_t kGapBins = 25;
+
+// Running timing state for one (bus, CAN ID).
+struct IdTiming {
+    uint8_t bus = 0;
+    uint32_t can_id = 0;
+    std::string name;                 // empty for IDs not in the DBC
+    uint32_t cycle_ms = 0;            // GenMsgCycleTime, 0 = undeclared
+    uint64_t frames = 0;
+    int64_t first_ns = 0;
+    int64_t last_ns = 0;
+    int64_t min_gap_ns = 0;
+    int64_t max_gap_ns = 0;
+    double gap_mean_ns = 0.0;         // Welford running mean / M2
+    double gap_m2 = 0.0;
+    uint64_t late = 0;                // gaps over late_factor * cycle
+    uint64_t missed = 0;              // estimated frames lost inside those gaps
+    int64_t last_alert_ns = 0;
+    bool stale = false;               // missing-frame alert raised, cleared on next frame
+    std::array<uint32_t, kGapBins> hist{};
+
+    double jitter_ns() const;         // standard deviation of the gap
+};
+
+struct BusLoad {
+    uint32_t bitrate = 0;
+    int64_t window_start_ns = 0;
+    int64_t last_ns = 0;
+    uint64_t window_bits = 0;
+    uint64_t total_bits = 0;
+    uint64_t frames = 0;
+    uint64_t windows = 0;
+    double peak = 0.0;                // highest completed-window load (0..1+)
+    double sum = 0.0;                 // sum of completed-window loads
+};
+
+struct TimingAlert {
+    enum class Kind { Late, Missing, BusLoad };
+    Kind kind = Kind::Late;
+    uint8_t bus = 0;
+    uint32_t can_id = 0;
+    int64_t ts_ns = 0;
+    int64_t gap_ns = 0;               // Late/Missing: time since the previous frame
+    double load = 0.0;                // BusLoad: window load (0..1+)
+    const IdTiming* id = nullptr;     // null for BusLoad
+};
+
+// Single-pass per-(bus, ID) inter-arrival histogram, jitter, late/missed
+// counts and bus load, checked against the DBC's GenMsgCycleTime. O(1) work
+// per frame plus one scan of the periodic IDs per load window. A frame only
+// closes windows on its own bus, so a bus that stops altogether is caught by
+// tick() and finish() instead.
+class BusTiming : public Checkpointable {
+public:
+    using AlertFn = std::function<void(const TimingAlert&)>;
+
+    explicit BusTiming(TimingConfig cfg = {});
+
+    // Register every message of `net` on `bus` with its declared cycle time.
+    void declare_network(uint8_t bus, const dbcppp::INetwork& net);
+    void declare(uint8_t bus, uint32_t can_id, const std::string& name, uint32_t cycle_ms);
+
+    void set_alert_handler(AlertFn fn) { alert_ = std::move(fn); }
+
+    // Account one frame; call for every frame on the bus, known or not.
+    void observe(uint8_t bus, const ParsedLine& pl);
+
+    // Check every bus for periodic IDs gone quiet as of `now_ns` (log time),
+    // whether or not frames are still arriving; call while idle.
+    void tick(int64_t now_ns);
+
+    // Check every bus against the newest frame seen on any of them, then
+    // close the current load windows (end of input).
+    void finish();
+
+    const std::vector<IdTiming>& ids() const { return ids_; }
+    const std::vector<BusLoad>& buses() const { return buses_; }
+
+    // Compact per-ID table followed by per-bus load.
+    void write_report(std::ostream& os) const;
+
+    // Nominal bits on the wire for a classic CAN frame incl. IFS, without
+    // stuff bits (so bus load is a lower bound; worst-case stuffing adds ~20%).
+    static uint32_t frame_bits(uint32_t can_id, size_t dlc);
+
+    // Every IdTiming and BusLoad field; declared names/cycles are kept.
+    const char* checkpoint_key() const override { return "bus_timing"; }
+    void save_state(std::ostream& os) const override;
+    bool load_state(std::istream& is) override;
+
+private:
+    IdTiming& slot(uint8_t bus, uint32_t can_id);
+    BusLoad& bus(uint8_t b);
+    void close_window(uint8_t b);
+    void check_missing(IdTiming& t, int64_t now_ns);
+    void scan_missing(uint8_t b, int64_t now_ns);
+    void raise(const TimingAlert& a);
+
+    TimingConfig cfg_;
+    AlertFn alert_;
+    std::vector<IdTiming> ids_;
+    std::unordered_map<uint64_t, uint32_t> index_;   // (bus << 32 | id) -> ids_
+    std::vector<BusLoad> buses_;
+};
+
+const char* to_string(TimingAlert::Kind k);
+
+} // namespace rbk
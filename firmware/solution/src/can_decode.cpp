@@ -1,9 +1,11 @@
 #include "can_decode.hpp"
+#include "timestamp.hpp"
+#include <cctype>
 #include <cstring>
 #include <fstream>
 #include <iomanip>
-#include <regex>
-#include <sstream>
+#include <utility>
+#include <variant>
 
 namespace rbk {
 
@@ -14,39 +16,108 @@ std::string canonical_iface(const std::string& s) {
     return s;
 }
 
-bool parse_line(const std::string& line, ParsedLine& out) {
-    static const std::regex rx(
-        R"(^\(([\d]+\.[\d]+)\)\s+([A-Za-z0-9_]+)\s+([0-9A-Fa-f]+)#([0-9A-Fa-f]+)\s*$)"
-    );
-    std::smatch m;
-    if (!std::regex_match(line, m, rx)) return false;
-
-    out.timestamp = std::stod(m[1].str());
-    out.iface = canonical_iface(m[2].str());
-
-    std::stringstream ss;
-    ss << std::hex << m[3].str();
-    uint32_t id_hex = 0;
-    ss >> id_hex;
-    out.can_id = id_hex;
-
-    const std::string hex = m[4].str();
+static inline bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+static inline int hex_val(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Hand-rolled equivalent of
+//   ^\(([\d]+\.[\d]+)\)\s+([A-Za-z0-9_]+)\s+([0-9A-Fa-f]+)#([0-9A-Fa-f]+)\s*$
+// with the timestamp parsed straight to integer nanoseconds. The interface
+// is resolved through `buses`; `iface` (when non-null) receives its span.
+static bool parse_line_impl(const std::string& line, ParsedLine& out, const BusMap& buses,
+                            std::pair<const char*, const char*>* iface) {
+    const char* p = line.data();
+    const char* end = p + line.size();
+
+    // (seconds.fraction)
+    if (p == end || *p != '(') return false;
+    const char* ts_begin = ++p;
+    while (p < end && *p != ')') ++p;
+    if (p == end) return false;
+    int64_t ts_ns = 0;
+    if (!parse_timestamp(ts_begin, p, ts_ns)) return false;
+    ++p;
+
+    // interface
+    const char* ws = p;
+    while (p < end && is_space(*p)) ++p;
+    if (p == ws) return false;
+    const char* if_begin = p;
+    while (p < end && (std::isalnum(static_cast<unsigned char>(*p)) || *p == '_')) ++p;
+    if (p == if_begin) return false;
+    const char* if_end = p;
+
+    // ID#
+    ws = p;
+    while (p < end && is_space(*p)) ++p;
+    if (p == ws) return false;
+    uint64_t id = 0;
+    const char* id_begin = p;
+    int v;
+    while (p < end && (v = hex_val(*p)) >= 0) {
+        id = (id << 4) | static_cast<uint64_t>(v);
+        if (id > 0xFFFFFFFFULL) id = 0x1FFFFFFFFULL; // saturate like istream >> uint32_t
+        ++p;
+    }
+    if (p == id_begin || p == end || *p != '#') return false;
+    ++p;
+
+    // payload: validate fully before touching `out`
+    const char* hex_begin = p;
+    while (p < end && hex_val(*p) >= 0) ++p;
+    const char* hex_end = p;
+    if (hex_end == hex_begin) return false;
+    while (p < end && is_space(*p)) ++p;
+    if (p != end) return false;
+
+    out.ts_ns = ts_ns;
+    out.bus = buses.lookup(if_begin, static_cast<size_t>(if_end - if_begin));
+    if (iface) *iface = {if_begin, if_end};
+    out.can_id = id > 0xFFFFFFFFULL ? 0xFFFFFFFFu : static_cast<uint32_t>(id);
+
     out.data.clear();
-    out.data.reserve(hex.size() / 2);
-    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
-        std::string byte_str = hex.substr(i, 2);
-        uint8_t byte = static_cast<uint8_t>(std::stoul(byte_str, nullptr, 16));
-        out.data.push_back(byte);
+    for (const char* h = hex_begin; h + 1 < hex_end; h += 2) {
+        out.data.push_back(static_cast<uint8_t>((hex_val(h[0]) << 4) | hex_val(h[1])));
     }
     return true;
 }
 
+bool parse_line(const std::string& line, ParsedLine& out, const BusMap& buses) {
+    if (!parse_line_impl(line, out, buses, nullptr)) return false;
+    out.iface.clear(); // keeps its capacity, so still no allocation
+    return true;
+}
+
+bool parse_line(const std::string& line, ParsedLine& out) {
+    std::pair<const char*, const char*> iface;
+    if (!parse_line_impl(line, out, BusMap::builtin(), &iface)) return false;
+    out.iface = canonical_iface(std::string(iface.first, iface.second));
+    return true;
+}
+
 std::unique_ptr<dbcppp::INetwork> load_network(const std::string& path) {
     std::ifstream is(path);
     if (!is) return nullptr;
     return dbcppp::INetwork::LoadDBCFromIs(is);
 }
 
+uint32_t cycle_time_ms(const dbcppp::IMessage& msg) {
+    for (const dbcppp::IAttribute& attr : msg.AttributeValues()) {
+        if (attr.Name() != "GenMsgCycleTime") continue;
+        const auto& v = attr.Value();
+        if (const auto* i = std::get_if<int64_t>(&v)) return *i > 0 ? static_cast<uint32_t>(*i) : 0;
+        if (const auto* d = std::get_if<double>(&v)) return *d > 0 ? static_cast<uint32_t>(*d) : 0;
+    }
+    return 0;
+}
+
 MsgMap build_msg_map(const dbcppp::INetwork& net) {
     MsgMap mm;
     for (const dbcppp::IMessage& msg : net.Messages()) {
@@ -72,6 +143,8 @@ size_t decode_and_write(
 
     const dbcppp::ISignal* mux_sig = msg->MuxSignal();
     size_t wrote = 0;
+    char ts[kTimestampBufLen];
+    const auto ts_len = static_cast<std::streamsize>(format_timestamp(pl.ts_ns, ts));
 
     for (const dbcppp::ISignal& sig : msg->Signals()) {
         bool take = true;
@@ -87,8 +160,9 @@ size_t decode_and_write(
 
         const auto raw = sig.Decode(data_buf);
         const auto phys = sig.RawToPhys(raw);
-        os << '(' << std::setprecision(15) << pl.timestamp << "): "
-           << sig.Name() << ": " << phys << "\n";
+        os << '(';
+        os.write(ts, ts_len);
+        os << "): " << sig.Name() << ": " << std::setprecision(15) << phys << "\n";
         ++wrote;
     }
     return wrote;
@@ -1,4 +1,5 @@
 #pragma once
+#include "bus_map.hpp"
 #include <dbcppp/Network.h>
 #include <cstdint>
 #include <memory>
@@ -10,8 +11,9 @@
 namespace rbk {
 
 struct ParsedLine {
-    double timestamp = 0.0;
-    std::string iface;
+    int64_t ts_ns = 0;          // UNIX time in nanoseconds
+    std::string iface;          // BusMap-less parse_line() only; the other clears it
+    uint8_t bus = kNoBus;       // BusMap index of the interface
     uint32_t can_id = 0;
     std::vector<uint8_t> data;
 };
@@ -19,12 +21,20 @@ struct ParsedLine {
 // Canonicalize canX/vcanX to canX
 std::string canonical_iface(const std::string& s);
 
-// Parse one cangen/candump-style line: "(ts) iface ID#HEXDATA"
+// Parse one cangen/candump-style line: "(ts) iface ID#HEXDATA". The
+// interface is resolved to `out.bus` without allocating and `out.iface` is
+// left empty; unknown interfaces parse fine and get kNoBus.
+bool parse_line(const std::string& line, ParsedLine& out, const BusMap& buses);
+
+// As above with BusMap::builtin(), also filling the canonical `out.iface`.
 bool parse_line(const std::string& line, ParsedLine& out);
 
 // Load a DBC from path
 std::unique_ptr<dbcppp::INetwork> load_network(const std::string& path);
 
+// GenMsgCycleTime of a message in ms; 0 if undeclared (the DBC default).
+uint32_t cycle_time_ms(const dbcppp::IMessage& msg);
+
 // Map message id -> message*
 using MsgMap = std::unordered_map<uint32_t, const dbcppp::IMessage*>;
 MsgMap build_msg_map(const dbcppp::INetwork& net);
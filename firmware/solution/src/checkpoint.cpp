@@ -0,0 +1,180 @@
+#include "checkpoint.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace rbk {
+
+namespace {
+
+constexpr const char* kMagic = "rbk-checkpoint";
+constexpr int kVersion = 1;
+
+bool set_err(std::string* err, const std::string& what) {
+    if (err) *err = what;
+    return false;
+}
+
+// Raw bytes as hex, "-" when empty, so the field is always one token.
+std::string to_hex(const std::string& s) {
+    if (s.empty()) return "-";
+    static const char hex[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(s.size() * 2);
+    for (unsigned char c : s) {
+        out.push_back(hex[c >> 4]);
+        out.push_back(hex[c & 0xF]);
+    }
+    return out;
+}
+
+bool from_hex(const std::string& h, std::string& out) {
+    out.clear();
+    if (h == "-") return true;
+    if (h.size() % 2) return false;
+    auto nibble = [](char c) {
+        return c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+    };
+    for (size_t i = 0; i < h.size(); i += 2) {
+        const int hi = nibble(h[i]), lo = nibble(h[i + 1]);
+        if (hi < 0 || lo < 0) return false;
+        out.push_back(static_cast<char>(hi << 4 | lo));
+    }
+    return true;
+}
+
+} // namespace
+
+void put_double(std::ostream& os, double d) {
+    uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(bits));
+    const auto f = os.flags();
+    os << std::hex << bits;
+    os.flags(f);
+}
+
+bool get_double(std::istream& is, double& d) {
+    uint64_t bits = 0;
+    const auto f = is.flags();
+    is >> std::hex >> bits;
+    is.flags(f);
+    if (!is) return false;
+    std::memcpy(&d, &bits, sizeof(d));
+    return true;
+}
+
+bool write_checkpoint(const std::string& path, const CheckpointHeader& hdr,
+                      const std::vector<const Checkpointable*>& parts, std::string* err) {
+    std::ostringstream os;
+    os << kMagic << ' ' << kVersion << "\n"
+       << "log " << hdr.log << "\n"
+       << "inode " << hdr.inode << "\n"
+       << "offset " << hdr.offset << "\n"
+       << "tail " << to_hex(hdr.log_tail) << "\n"
+       << "lines " << hdr.lines << "\n"
+       << "last_ts_ns " << hdr.last_ts_ns << "\n"
+       << "output_bytes " << hdr.output_bytes << "\n";
+    for (const Checkpointable* p : parts) {
+        std::ostringstream body;
+        p->save_state(body);
+        const std::string b = body.str();
+        os << "section " << p->checkpoint_key() << ' ' << b.size() << "\n" << b;
+    }
+    os << "end\n";
+    const std::string data = os.str();
+
+    const std::string tmp = path + ".tmp";
+    const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return set_err(err, "open " + tmp + ": " + std::strerror(errno));
+    size_t done = 0;
+    while (done < data.size()) {
+        const ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            const int e = errno;
+            ::close(fd);
+            return set_err(err, "write " + tmp + ": " + std::strerror(e));
+        }
+        done += static_cast<size_t>(n);
+    }
+    if (::fsync(fd) != 0 || ::close(fd) != 0) return set_err(err, "fsync " + tmp + ": " + std::strerror(errno));
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        return set_err(err, "rename " + tmp + ": " + std::strerror(errno));
+    }
+    return true;
+}
+
+bool read_checkpoint(const std::string& path, CheckpointHeader& hdr, const std::vector<Checkpointable*>& parts,
+                     std::vector<std::string>* skipped, std::string* err) {
+    std::ifstream is(path, std::ios::binary);
+    if (!is) return set_err(err, "cannot open " + path);
+
+    std::string magic;
+    int version = 0;
+    if (!(is >> magic >> version) || magic != kMagic || version != kVersion) {
+        return set_err(err, path + ": not a version " + std::to_string(kVersion) + " checkpoint");
+    }
+
+    std::map<std::string, Checkpointable*> by_key;
+    for (Checkpointable* p : parts) by_key[p->checkpoint_key()] = p;
+    std::map<std::string, bool> loaded;
+
+    CheckpointHeader h;
+    std::string key;
+    bool ended = false;
+    while (!ended && is >> key) {
+        if (key == "log") {
+            is.ignore(1);
+            std::getline(is, h.log);
+        } else if (key == "inode") {
+            is >> h.inode;
+        } else if (key == "offset") {
+            is >> h.offset;
+        } else if (key == "tail") {
+            std::string hex;
+            if (!(is >> hex) || !from_hex(hex, h.log_tail)) break;
+        } else if (key == "lines") {
+            is >> h.lines;
+        } else if (key == "last_ts_ns") {
+            is >> h.last_ts_ns;
+        } else if (key == "output_bytes") {
+            is >> h.output_bytes;
+        } else if (key == "section") {
+            std::string name;
+            size_t len = 0;
+            if (!(is >> name >> len)) break;
+            is.ignore(1); // '\n'
+            std::string body(len, '\0');
+            if (!is.read(&body[0], static_cast<std::streamsize>(len))) break;
+            auto it = by_key.find(name);
+            if (it != by_key.end()) {
+                std::istringstream bs(body);
+                loaded[name] = it->second->load_state(bs);
+            }
+        } else if (key == "end") {
+            ended = true;
+        } else {
+            break;
+        }
+        if (!is) break;
+    }
+    if (!ended) return set_err(err, path + ": truncated or corrupt checkpoint");
+
+    hdr = h;
+    if (skipped) {
+        skipped->clear();
+        for (Checkpointable* p : parts) {
+            auto it = loaded.find(p->checkpoint_key());
+            if (it == loaded.end() || !it->second) skipped->push_back(p->checkpoint_key());
+        }
+    }
+    return true;
+}
+
+} // namespace rbk
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace rbk {
+
+// A component whose accumulated state survives a decoder restart. State is
+// plain text; write doubles with put_double() so they round-trip bit-exact.
+class Checkpointable {
+public:
+    virtual ~Checkpointable() = default;
+    // Section name in the checkpoint file (no whitespace).
+    virtual const char* checkpoint_key() const = 0;
+    virtual void save_state(std::ostream& os) const = 0;
+    // Restore from exactly what save_state() wrote; false leaves the
+    // component as freshly constructed.
+    virtual bool load_state(std::istream& is) = 0;
+};
+
+// Doubles as their IEEE-754 bit pattern in hex (exact, NaN/inf included).
+void put_double(std::ostream& os, double d);
+bool get_double(std::istream& is, double& d);
+
+// Where the decoder was when the checkpoint was taken.
+struct CheckpointHeader {
+    std::string log;            // input path
+    uint64_t inode = 0;         // detects a replaced/rotated log
+    uint64_t offset = 0;        // bytes of the log consumed (always a line boundary)
+    std::string log_tail;       // last bytes before `offset`; detects a log rewritten in place
+    uint64_t lines = 0;
+    int64_t last_ts_ns = 0;
+    uint64_t output_bytes = 0;  // output.txt length matching `offset`
+};
+
+// Written to `path`.tmp, fsync'd and renamed over `path`, so a crash leaves
+// either the old or the new checkpoint. Each component gets a length-prefixed
+// section; readers skip sections they do not know.
+bool write_checkpoint(const std::string& path, const CheckpointHeader& hdr,
+                      const std::vector<const Checkpointable*>& parts, std::string* err = nullptr);
+
+// Reads the header and hands each known section to its component. A
+// component whose section is missing or fails to load is reported in
+// `skipped` (by key) and left fresh.
+bool read_checkpoint(const std::string& path, CheckpointHeader& hdr, const std::vector<Checkpointable*>& parts,
+                     std::vector<std::string>* skipped = nullptr, std::string* err = nullptr);
+
+} // namespace rbk
@@ -1,7 +1,10 @@
 #include "dbc_simple.hpp"
+#include "timestamp.hpp"
 #include <regex>
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <limits>
 #include <iomanip>
@@ -31,13 +34,26 @@ static uint64_t extract_le(const std::vector<uint8_t>& data, uint16_t start, uin
     return result;
 }
 
+// Inverse of extract_le: write `length` bits of `raw` starting at `start`.
+static void insert_le(std::vector<uint8_t>& data, uint16_t start, uint16_t length, uint64_t raw) {
+    for (unsigned k = 0; k < length; ++k) {
+        unsigned bit_index = start + k;
+        unsigned byte = bit_index / 8;
+        unsigned bit  = bit_index % 8;
+        if (byte >= data.size()) data.resize(byte + 1, 0);
+        const uint8_t b = static_cast<uint8_t>(1u << bit);
+        if ((raw >> k) & 0x1) data[byte] |= b;
+        else                  data[byte] &= static_cast<uint8_t>(~b);
+    }
+}
+
 // Extract raw unsigned value for big-endian (@0 / Motorola) signals.
-// DBC start bit refers to the *MSB* of the signal at (byte = s/8, bit = 7 - (s%8)),
+// DBC start bit refers to the *MSB* of the signal at (byte = s/8, bit = s%8),
 // subsequent bits proceed toward less significant bits; when bit < 0, move to next byte (+1) and bit=7.
 static uint64_t extract_be(const std::vector<uint8_t>& data, uint16_t start, uint16_t length) {
     uint64_t result = 0;
     int byte = static_cast<int>(start / 8);
-    int bit  = 7 - static_cast<int>(start % 8);
+    int bit  = static_cast<int>(start % 8);
 
     for (unsigned i = 0; i < length; ++i) {
         uint8_t v = 0;
@@ -49,13 +65,32 @@ static uint64_t extract_be(const std::vector<uint8_t>& data, uint16_t start, uin
         // move to next lower bit; wrap to next byte when needed
         --bit;
         if (bit < 0) {
-            --byte;
+            ++byte;
             bit = 7;
         }
     }
     return result;
 }
 
+// Inverse of extract_be: MSB first from the start bit, same bit walk.
+static void insert_be(std::vector<uint8_t>& data, uint16_t start, uint16_t length, uint64_t raw) {
+    int byte = static_cast<int>(start / 8);
+    int bit  = static_cast<int>(start % 8);
+
+    for (unsigned i = 0; i < length; ++i) {
+        const unsigned k = length - 1 - i; // MSB first
+        if (static_cast<size_t>(byte) >= data.size()) data.resize(static_cast<size_t>(byte) + 1, 0);
+        const uint8_t b = static_cast<uint8_t>(1u << bit);
+        if ((raw >> k) & 0x1) data[byte] |= b;
+        else                  data[byte] &= static_cast<uint8_t>(~b);
+        --bit;
+        if (bit < 0) {
+            ++byte;
+            bit = 7;
+        }
+    }
+}
+
 // ------------------ parser ------------------
 static inline std::string trim(const std::string& s) {
     size_t b = s.find_first_not_of(" \t\r\n");
@@ -194,6 +229,27 @@ bool parse_dbc_file(const std::string& path, Network& out, std::string* err) {
                 }
             }
 
+            // "[min|max]" physical limits and the quoted unit follow the factors
+            double minimum = 0.0, maximum = 0.0;
+            std::string unit;
+            const size_t after = (rpar == std::string::npos) ? 0 : rpar + 1;
+            auto lbr = right.find('[', after);
+            auto rbr = right.find(']', lbr == std::string::npos ? after : lbr + 1);
+            if (lbr != std::string::npos && rbr != std::string::npos) {
+                std::string mm = right.substr(lbr + 1, rbr - lbr - 1); // "min|max"
+                auto bar = mm.find('|');
+                if (bar != std::string::npos) {
+                    try {
+                        minimum = std::stod(trim(mm.substr(0, bar)));
+                        maximum = std::stod(trim(mm.substr(bar + 1)));
+                    } catch (...) {
+                        minimum = maximum = 0.0;
+                    }
+                }
+                auto q1 = right.find('"', rbr + 1);
+                auto q2 = (q1 == std::string::npos) ? q1 : right.find('"', q1 + 1);
+                if (q2 != std::string::npos) unit = right.substr(q1 + 1, q2 - q1 - 1);
+            }
 
             // Construct Signal
             Signal s;
@@ -208,20 +264,45 @@ bool parse_dbc_file(const std::string& path, Network& out, std::string* err) {
             s.is_signed     = (sign_ch == '-');
             s.scale         = scale;
             s.offset        = offset;
+            s.minimum       = minimum;
+            s.maximum       = maximum;
+            s.unit          = std::move(unit);
 
+#ifdef DEBUG
             std::cerr << "Parsed signal: " << s.name
                         << " start=" << s.start_bit
                         << " len=" << s.bit_len
                         << " endian=" << (s.little_endian ? "LE" : "BE")
                         << " signed=" << s.is_signed
                         << " scale=" << s.scale
-                        << " offset=" << s.offset << "\n";
+                        << " offset=" << s.offset
+                        << " range=[" << s.minimum << "|" << s.maximum << "]"
+                        << " unit=" << s.unit << "\n";
+#endif
 
 
             current->signals.push_back(std::move(s));
             continue;
         }
 
+        // -------- BA_ "GenMsgCycleTime" BO_ <id> <ms>; --------
+        if (starts_with(line, "BA_ \"GenMsgCycleTime\"")) {
+            std::istringstream ls(line);
+            std::string tag, attr, obj, id_str, val_str;
+            ls >> tag >> attr >> obj >> id_str >> val_str;
+            if (obj != "BO_") continue;
+            if (!val_str.empty() && val_str.back() == ';') val_str.pop_back();
+            try {
+                auto it = out.msgs.find(static_cast<uint32_t>(std::stoul(id_str, nullptr, 0)));
+                if (it != out.msgs.end()) {
+                    it->second.cycle_time_ms = static_cast<uint32_t>(std::stoul(val_str));
+                }
+            } catch (...) {
+                // malformed attribute; leave undeclared
+            }
+            continue;
+        }
+
         // Ignore all other lines (NS_, BS_, BU_, VAL_, BO_TX_BU_, comments, etc.)
     }
 
@@ -259,7 +340,7 @@ double decode_signal_phys(const Signal& sig, const std::vector<uint8_t>& data) {
 
 size_t decode_frame_and_write(const Network& net,
                               uint32_t can_id,
-                              double timestamp,
+                              int64_t ts_ns,
                               const std::vector<uint8_t>& data,
                               std::ostream& os)
 {
@@ -268,13 +349,53 @@ size_t decode_frame_and_write(const Network& net,
 
     const Message& msg = it->second;
     size_t count = 0;
+    char ts[rbk::kTimestampBufLen];
+    const auto ts_len = static_cast<std::streamsize>(rbk::format_timestamp(ts_ns, ts));
     for (const auto& sig : msg.signals) {
         const double phys = decode_signal_phys(sig, data);
-        os << '(' << std::setprecision(15) << timestamp << "): "
-           << sig.name << ": " << phys << "\n";
+        os << '(';
+        os.write(ts, ts_len);
+        os << "): " << sig.name << ": " << std::setprecision(15) << phys << "\n";
         ++count;
     }
     return count;
 }
 
+// ------------------ encoding ------------------
+uint64_t phys_to_raw(const Signal& sig, double phys) {
+    if (sig.bit_len == 0) return 0;
+    const double scale = sig.scale != 0.0 ? sig.scale : 1.0;
+    const double r = std::nearbyint((phys - sig.offset) / scale);
+
+    if (sig.is_signed) {
+        const double lo = -std::ldexp(1.0, sig.bit_len - 1);
+        const double hi = std::ldexp(1.0, sig.bit_len - 1) - 1.0;
+        const int64_t v = static_cast<int64_t>(std::min(std::max(r, lo), hi));
+        return static_cast<uint64_t>(v) & mask_nbits(sig.bit_len);
+    }
+    const double hi = static_cast<double>(mask_nbits(sig.bit_len));
+    if (!(r > 0.0)) return 0; // also catches NaN
+    if (r >= hi) return mask_nbits(sig.bit_len);
+    return static_cast<uint64_t>(r);
+}
+
+void encode_signal_raw(const Signal& sig, uint64_t raw, std::vector<uint8_t>& data) {
+    raw &= mask_nbits(sig.bit_len);
+    if (sig.little_endian) {
+        insert_le(data, sig.start_bit, sig.bit_len, raw);
+    } else {
+        insert_be(data, sig.start_bit, sig.bit_len, raw);
+    }
+}
+
+bool encode_frame(const Message& msg, const std::vector<double>& phys, std::vector<uint8_t>& out) {
+    if (phys.size() != msg.signals.size()) return false;
+    out.assign(msg.dlc, 0);
+    for (size_t i = 0; i < msg.signals.size(); ++i) {
+        encode_signal_raw(msg.signals[i], phys_to_raw(msg.signals[i], phys[i]), out);
+    }
+    out.resize(msg.dlc); // a signal reaching past the DLC must not grow the frame
+    return true;
+}
+
 } // namespace stage4
@@ -16,12 +16,18 @@ struct Signal {
     bool is_signed = false;    // '+' unsigned, '-' signed
     double scale = 1.0;
     double offset = 0.0;
+    double minimum = 0.0;      // [min|max] physical limits; 0|0 = none declared
+    double maximum = 0.0;
+    std::string unit;
+
+    bool has_limits() const { return minimum < maximum; }
 };
 
 struct Message {
     uint32_t id = 0;          // decimal in DBC
     std::string name;
     uint8_t dlc = 8;
+    uint32_t cycle_time_ms = 0; // BA_ "GenMsgCycleTime"; 0 = not periodic / undeclared
     std::vector<Signal> signals;
 };
 
@@ -36,8 +42,20 @@ bool parse_dbc_file(const std::string& path, Network& out, std::string* err = nu
 double decode_signal_phys(const Signal& sig, const std::vector<uint8_t>& data);
 size_t decode_frame_and_write(const Network& net,
                               uint32_t can_id,
-                              double timestamp,
+                              int64_t ts_ns,
                               const std::vector<uint8_t>& data,
                               std::ostream& os);
 
+// ---------- Encoding ----------
+// Physical -> raw: round((phys - offset) / scale), saturated to the signal's
+// bit range (two's complement for signed signals, already masked).
+uint64_t phys_to_raw(const Signal& sig, double phys);
+
+// Insert a raw value into `data` (grown to cover the signal if needed).
+void encode_signal_raw(const Signal& sig, uint64_t raw, std::vector<uint8_t>& data);
+
+// Pack one physical value per signal (msg.signals order) into a fresh
+// payload of msg.dlc bytes. Returns false if the value count does not match.
+bool encode_frame(const Message& msg, const std::vector<double>& phys, std::vector<uint8_t>& out);
+
 } // namespace stage4
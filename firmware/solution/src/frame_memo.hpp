@@ -0,0 +1,70 @@
+#pragma once
+#include "sample_sink.hpp"
+#include "signal_catalog.hpp"
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace rbk {
+
+struct MemoStats {
+    uint64_t hits = 0;          // payload identical to the previous frame of the ID
+    uint64_t misses = 0;        // decoded (first frame or payload changed)
+    uint64_t timed_misses = 0;  // misses that were timed (1 in kMissTimingStride)
+    uint64_t miss_decode_ns = 0; // time spent decoding the timed misses
+
+    double hit_rate() const {
+        const uint64_t n = hits + misses;
+        return n ? static_cast<double>(hits) / static_cast<double>(n) : 0.0;
+    }
+    // Estimated decode time avoided: every hit would have cost an average
+    // (sampled) miss.
+    double saved_ns() const {
+        return timed_misses ? static_cast<double>(hits) * static_cast<double>(miss_decode_ns) /
+                                  static_cast<double>(timed_misses)
+                            : 0.0;
+    }
+};
+
+// One cached decode result; `signal` is a SignalCatalog index.
+struct MemoSample {
+    uint32_t signal = 0;
+    double value = 0.0;
+};
+
+// Per-message cache of the last raw payload and the samples it decoded to.
+// Classic CAN payloads (<= 8 bytes) are compared as one 64-bit word; longer
+// (FD) payloads fall back to a byte compare. Indexed by CatalogMessage::index.
+class FrameMemo {
+public:
+    // Only every Nth miss reads the clock, keeping the two clock reads out of
+    // the common miss path; the first miss is always timed.
+    static constexpr uint64_t kMissTimingStride = 256;
+
+    explicit FrameMemo(const SignalCatalog& cat);
+
+    const MemoStats& stats() const { return stats_; }
+    void write_stats(std::ostream& os) const;
+
+private:
+    struct Entry {
+        bool valid = false;
+        uint8_t len = 0;
+        uint64_t word = 0;               // payload bytes 0..7, zero padded
+        std::vector<uint8_t> fd;         // full payload when len > 8
+        std::vector<MemoSample> samples; // in emission order
+    };
+
+    friend size_t decode_frame(const ParsedLine&, uint8_t, const SignalCatalog&, SampleSink&, FrameMemo&);
+
+    std::vector<Entry> entries_;
+    MemoStats stats_;
+};
+
+// decode_frame() with memoisation: when the payload matches the previous frame
+// of the same ID, the cached values are re-emitted with the new timestamp and
+// no signal is extracted. Sinks see exactly the same samples either way.
+size_t decode_frame(const ParsedLine& pl, uint8_t bus, const SignalCatalog& cat, SampleSink& sink,
+                    FrameMemo& memo);
+
+} // namespace rbk
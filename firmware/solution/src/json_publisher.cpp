@@ -0,0 +1,254 @@
+#include "json_publisher.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace rbk {
+
+// How long a send waits for socket buffer space before checking for
+// shutdown again.
+static constexpr int kSendPollMs = 100;
+
+JsonPublisher::JsonPublisher(const SignalCatalog& cat, PublisherConfig cfg)
+    : cat_(cat), cfg_(std::move(cfg)) {
+    batch_.reserve(cfg_.max_batch_bytes + 256);
+    batch_start_ = std::chrono::steady_clock::now();
+    worker_ = std::thread(&JsonPublisher::run, this);
+}
+
+JsonPublisher::~JsonPublisher() {
+    flush();
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    // The worker sees stop_ within kSendPollMs even mid-send and closes the
+    // socket itself; nothing here touches it.
+    if (worker_.joinable()) worker_.join();
+}
+
+void JsonPublisher::begin_frame(const ParsedLine& /*pl*/, uint8_t bus) {
+    bus_ = bus;
+}
+
+void JsonPublisher::on_sample(const Sample& s) {
+    // Signal names are DBC identifiers, so they never need JSON escaping.
+    char num[96];
+    // milliseconds with microsecond fraction, formatted from the integer ns
+    const long long us = static_cast<long long>(s.ts_ns / 1000);
+    const int n = std::snprintf(num, sizeof(num), "{\"timestamp\":%lld.%03lld,\"bus\":%u,\"signal\":\"",
+                                us / 1000, us % 1000, static_cast<unsigned>(bus_));
+    batch_.append(num, static_cast<size_t>(n));
+    batch_ += cat_.info(s.signal).name;
+    // Flagged samples (RangePolicy::Flag) carry one extra member.
+    const int m = std::snprintf(num, sizeof(num), "\",\"value\":%.15g%s}\n", s.value,
+                                (s.flags & kSampleOutOfRange) ? ",\"out_of_range\":true" : "");
+    batch_.append(num, static_cast<size_t>(m));
+    ++batch_samples_;
+}
+
+void JsonPublisher::end_frame() {
+    if (batch_.empty()) return;
+    if (cfg_.flush_interval_ms <= 0 || batch_.size() >= cfg_.max_batch_bytes) {
+        enqueue_batch();
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (now - batch_start_ >= std::chrono::milliseconds(cfg_.flush_interval_ms)) enqueue_batch();
+}
+
+void JsonPublisher::enqueue_batch() {
+    if (batch_.empty()) return;
+    Batch b;
+    b.text.reserve(cfg_.max_batch_bytes + 256);
+    b.text.swap(batch_);
+    b.samples = batch_samples_;
+    batch_samples_ = 0;
+    batch_start_ = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        if (queue_.size() >= cfg_.queue_batches) {
+            // drop-oldest: live telemetry prefers fresh data over completeness
+            stats_.batches_dropped++;
+            stats_.samples_dropped += queue_.front().samples;
+            queue_.pop_front();
+        }
+        stats_.samples_queued += b.samples;
+        queue_.push_back(std::move(b));
+    }
+    cv_.notify_one();
+}
+
+bool JsonPublisher::flush(std::chrono::milliseconds timeout) {
+    enqueue_batch();
+    std::unique_lock<std::mutex> lk(mu_);
+    return drained_.wait_for(lk, timeout, [&] { return queue_.empty() && !in_flight_; });
+}
+
+bool JsonPublisher::stopping() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return stop_;
+}
+
+PublisherStats JsonPublisher::stats() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return stats_;
+}
+
+bool JsonPublisher::connect_once() {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* res = nullptr;
+    const std::string port = std::to_string(cfg_.port);
+    if (::getaddrinfo(cfg_.host.c_str(), port.c_str(), &hints, &res) != 0) return false;
+
+    // Non-blocking connect bounded by connect_timeout_ms; the socket goes
+    // back to blocking mode for send().
+    int fd = -1;
+    for (addrinfo* ai = res; ai; ai = ai->ai_next) {
+        fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) continue;
+        const int flags = ::fcntl(fd, F_GETFL, 0);
+        ::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        int rc = ::connect(fd, ai->ai_addr, ai->ai_addrlen);
+        if (rc != 0 && errno == EINPROGRESS) {
+            pollfd p{fd, POLLOUT, 0};
+            int err = ETIMEDOUT;
+            socklen_t len = sizeof(err);
+            if (::poll(&p, 1, cfg_.connect_timeout_ms) == 1) ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len);
+            rc = err == 0 ? 0 : -1;
+        }
+        if (rc == 0) {
+            ::fcntl(fd, F_SETFL, flags);
+            break;
+        }
+        ::close(fd);
+        fd = -1;
+    }
+    ::freeaddrinfo(res);
+    if (fd < 0) return false;
+
+    const int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fd_ = fd;
+    connected_.store(true);
+    return true;
+}
+
+void JsonPublisher::close_socket() {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+    connected_.store(false);
+}
+
+bool JsonPublisher::send_all(const std::string& text, size_t& off) {
+    // Non-blocking sends, waiting in poll() for buffer space, so a peer that
+    // stops reading cannot hold up shutdown.
+    while (off < text.size()) {
+        const ssize_t n = ::send(fd_, text.data() + off, text.size() - off, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n > 0) {
+            off += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (stopping()) return false;
+            pollfd p{fd_, POLLOUT, 0};
+            if (::poll(&p, 1, kSendPollMs) >= 0 || errno == EINTR) continue;
+        }
+        return false;
+    }
+    return true;
+}
+
+void JsonPublisher::run() {
+    int backoff_ms = cfg_.reconnect_min_ms;
+    for (;;) {
+        Batch b;
+        {
+            std::unique_lock<std::mutex> lk(mu_);
+            cv_.wait(lk, [&] { return stop_ || !queue_.empty(); });
+            if (queue_.empty()) break; // stop_ with nothing left
+            b = std::move(queue_.front());
+            queue_.pop_front();
+            in_flight_ = true;
+        }
+
+        bool sent = false;
+        size_t off = 0;
+        while (!sent) {
+            if (fd_ < 0) {
+                {
+                    // Shutting down: drop the batch rather than dial again.
+                    std::lock_guard<std::mutex> lk(mu_);
+                    if (stop_) break;
+                }
+                if (!connect_once()) {
+                    std::unique_lock<std::mutex> lk(mu_);
+                    if (stop_) break;
+                    cv_.wait_for(lk, std::chrono::milliseconds(backoff_ms), [&] { return stop_; });
+                    backoff_ms = std::min(backoff_ms * 2, cfg_.reconnect_max_ms);
+                    continue;
+                }
+                backoff_ms = cfg_.reconnect_min_ms;
+                std::lock_guard<std::mutex> lk(mu_);
+                stats_.connects++;
+            }
+
+            if (send_all(b.text, off)) {
+                sent = true;
+            } else if (stopping()) {
+                break;  // stuck peer at shutdown: drop the rest of the batch
+            } else {
+                // Peer went away mid-batch. The receiver discards the partial
+                // line with the old socket; complete lines were delivered, so
+                // resume at the start of the cut one.
+                const size_t nl = off ? b.text.rfind('\n', off - 1) : std::string::npos;
+                off = nl == std::string::npos ? 0 : nl + 1;
+                close_socket();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            in_flight_ = false;
+            if (sent) {
+                stats_.batches_sent++;
+                stats_.bytes_sent += b.text.size();
+            } else {
+                stats_.batches_dropped++;
+                stats_.samples_dropped += b.samples;
+            }
+        }
+        drained_.notify_all();
+    }
+    close_socket();
+}
+
+bool parse_publish_target(const std::string& spec, PublisherConfig& cfg) {
+    const auto colon = spec.rfind(':');
+    if (colon == std::string::npos) {
+        if (!spec.empty()) cfg.host = spec;
+        return true;
+    }
+    if (colon > 0) cfg.host = spec.substr(0, colon);
+    try {
+        const unsigned long p = std::stoul(spec.substr(colon + 1));
+        if (p == 0 || p > 65535) return false;
+        cfg.port = static_cast<uint16_t>(p);
+    } catch (...) {
+        return false;
+    }
+    return true;
+}
+
+} // namespace rbk
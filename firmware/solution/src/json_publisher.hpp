@@ -0,0 +1,105 @@
+#pragma once
+#include "sample_sink.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace rbk {
+
+struct PublisherConfig {
+    std::string host = "127.0.0.1";
+    uint16_t port = 12000;               // spyder streaming-service TCP port
+    size_t queue_batches = 1024;         // bounded queue; oldest batch dropped when full
+    size_t max_batch_bytes = 64 * 1024;  // a batch is queued once it grows past this
+    int flush_interval_ms = 0;           // 0 = one batch per frame, else per time slice
+    int reconnect_min_ms = 100;
+    int reconnect_max_ms = 5000;
+    int connect_timeout_ms = 1000;       // per attempt, so shutdown never waits on a dead host
+};
+
+struct PublisherStats {
+    uint64_t samples_queued = 0;
+    uint64_t batches_sent = 0;
+    uint64_t bytes_sent = 0;
+    uint64_t batches_dropped = 0;
+    uint64_t samples_dropped = 0;
+    uint64_t connects = 0;
+};
+
+// Streams decoded samples as compact JSON lines over a persistent TCP
+// connection:
+//   {"timestamp":1705638799992.057,"bus":0,"signal":"Pack_SOC","value":14.5}
+// timestamp is UNIX milliseconds, as the streaming service expects. A sample
+// flagged by the range check gets "out_of_range":true after its value.
+//
+// The decode thread only formats into a batch and pushes it onto a bounded
+// queue; a background thread owns the socket, drains the queue and
+// reconnects with exponential backoff. It never blocks the decoder.
+//
+// Delivery is at most once per line. Lines the kernel had accepted when a
+// connection dropped may never arrive and are not resent; the line the
+// drop cut is resent whole on the next connection, so the service never
+// sees a partial line. When the queue is full the oldest batch is dropped,
+// as is a batch still unsent at shutdown; both are counted in stats().
+class JsonPublisher : public SampleSink {
+public:
+    JsonPublisher(const SignalCatalog& cat, PublisherConfig cfg);
+    ~JsonPublisher() override;
+
+    JsonPublisher(const JsonPublisher&) = delete;
+    JsonPublisher& operator=(const JsonPublisher&) = delete;
+
+    void begin_frame(const ParsedLine& pl, uint8_t bus) override;
+    void on_sample(const Sample& s) override;
+    void end_frame() override;
+
+    // Queue the pending batch and wait (up to `timeout`) for the queue to drain.
+    bool flush(std::chrono::milliseconds timeout = std::chrono::milliseconds(2000));
+
+    PublisherStats stats() const;
+    bool connected() const { return connected_.load(); }
+
+private:
+    void enqueue_batch();
+    void run();
+    bool connect_once();
+    void close_socket();
+    bool send_all(const std::string& text, size_t& off);
+    bool stopping() const;
+
+    const SignalCatalog& cat_;
+    PublisherConfig cfg_;
+
+    // producer side (decode thread only)
+    std::string batch_;
+    uint32_t batch_samples_ = 0;
+    uint8_t bus_ = 0;
+    std::chrono::steady_clock::time_point batch_start_;
+
+    // shared queue
+    struct Batch {
+        std::string text;
+        uint32_t samples = 0;
+    };
+    mutable std::mutex mu_;
+    std::condition_variable cv_;
+    std::condition_variable drained_;
+    std::deque<Batch> queue_;
+    bool in_flight_ = false;
+    bool stop_ = false;
+    PublisherStats stats_;
+
+    int fd_ = -1;                        // worker thread only
+    std::atomic<bool> connected_{false};
+    std::thread worker_;
+};
+
+// Parse "host[:port]" into cfg; returns false on a malformed port.
+bool parse_publish_target(const std::string& spec, PublisherConfig& cfg);
+
+} // namespace rbk
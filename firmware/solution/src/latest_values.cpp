@@ -0,0 +1,108 @@
+#include "latest_values.hpp"
+#include <cstring>
+#include <iomanip>
+#include <istream>
+#include <ostream>
+
+namespace rbk {
+
+LatestValueTable::LatestValueTable(const SignalCatalog& cat)
+    : cat_(cat), size_(cat.size()), slots_(new Slot[cat.size()]) {}
+
+void LatestValueTable::on_sample(const Sample& s) {
+    if (s.signal >= size_) return;
+    Slot& slot = slots_[s.signal];
+
+    uint64_t bits;
+    std::memcpy(&bits, &s.value, sizeof(bits));
+
+    // Single writer, so plain load + store is enough for the sequence.
+    const uint64_t seq = slot.seq.load(std::memory_order_relaxed);
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.value_bits.store(bits, std::memory_order_relaxed);
+    slot.ts_ns.store(s.ts_ns, std::memory_order_relaxed);
+    slot.updates.store(slot.updates.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    slot.seq.store(seq + 2, std::memory_order_release);
+}
+
+bool LatestValueTable::read(uint32_t index, LatestValue& out) const {
+    if (index >= size_) return false;
+    const Slot& slot = slots_[index];
+    for (;;) {
+        const uint64_t s1 = slot.seq.load(std::memory_order_acquire);
+        if (s1 & 1) continue; // writer mid-update; it finishes within nanoseconds
+        const uint64_t bits = slot.value_bits.load(std::memory_order_relaxed);
+        const int64_t ts = slot.ts_ns.load(std::memory_order_relaxed);
+        const uint64_t n = slot.updates.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != s1) continue;
+
+        std::memcpy(&out.value, &bits, sizeof(bits));
+        out.ts_ns = ts;
+        out.updates = n;
+        return n != 0;
+    }
+}
+
+bool LatestValueTable::read(const std::string& name, LatestValue& out) const {
+    const int64_t idx = cat_.index_of(name);
+    if (idx < 0) return false;
+    return read(static_cast<uint32_t>(idx), out);
+}
+
+void LatestValueTable::snapshot(std::vector<LatestValue>& out) const {
+    out.resize(size_);
+    for (size_t i = 0; i < size_; ++i) read(static_cast<uint32_t>(i), out[i]);
+}
+
+void LatestValueTable::dump(std::ostream& os) const {
+    std::vector<LatestValue> snap;
+    snapshot(snap);
+    os << std::setprecision(15);
+    for (size_t i = 0; i < snap.size(); ++i) {
+        if (!snap[i].updates) continue;
+        os << cat_.info(static_cast<uint32_t>(i)).name << ' ' << snap[i].value << ' '
+           << snap[i].ts_ns << ' ' << snap[i].updates << "\n";
+    }
+}
+
+void LatestValueTable::save_state(std::ostream& os) const {
+    std::vector<LatestValue> snap;
+    snapshot(snap);
+    os << "slots " << size_ << "\n";
+    for (size_t i = 0; i < snap.size(); ++i) {
+        if (!snap[i].updates) continue;
+        os << i << ' ';
+        put_double(os, snap[i].value);
+        os << ' ' << snap[i].ts_ns << ' ' << snap[i].updates << "\n";
+    }
+}
+
+bool LatestValueTable::load_state(std::istream& is) {
+    std::string tag;
+    size_t n = 0;
+    if (!(is >> tag >> n) || tag != "slots" || n != size_) return false; // catalog changed
+
+    std::vector<std::pair<size_t, LatestValue>> seen;
+    size_t idx;
+    while (is >> idx) {
+        LatestValue v;
+        get_double(is, v.value);
+        is >> v.ts_ns >> v.updates;
+        if (!is || idx >= size_) return false;
+        seen.emplace_back(idx, v);
+    }
+    for (const auto& e : seen) {
+        Slot& slot = slots_[e.first];
+        uint64_t bits;
+        std::memcpy(&bits, &e.second.value, sizeof(bits));
+        slot.value_bits.store(bits, std::memory_order_relaxed);
+        slot.ts_ns.store(e.second.ts_ns, std::memory_order_relaxed);
+        slot.updates.store(e.second.updates, std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    return true;
+}
+
+} // namespace rbk
@@ -0,0 +1,66 @@
+#pragma once
+#include "checkpoint.hpp"
+#include "sample_sink.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace rbk {
+
+// Consistent copy of one signal's most recent sample.
+struct LatestValue {
+    double value = 0.0;
+    int64_t ts_ns = 0;
+    uint64_t updates = 0;   // 0 = never seen
+};
+
+// "Current value of every signal on the car": one slot per SignalCatalog
+// index, written by the decode thread and readable from any thread.
+//
+// Each slot is a seqlock: the writer bumps the sequence to odd, stores the
+// fields and bumps it back to even; readers retry if the sequence was odd or
+// changed underneath them. The decode loop never waits on readers. Slots are
+// a cache line each, so a reader spinning on one signal never shares a line
+// with the writer's next store to another.
+class LatestValueTable : public SampleSink, public Checkpointable {
+public:
+    explicit LatestValueTable(const SignalCatalog& cat);
+
+    void on_sample(const Sample& s) override;
+
+    size_t size() const { return size_; }
+    int64_t index_of(const std::string& name) const { return cat_.index_of(name); }
+
+    // Single-slot read; returns false if the signal has never been updated.
+    bool read(uint32_t index, LatestValue& out) const;
+    bool read(const std::string& name, LatestValue& out) const;
+
+    // Bulk snapshot of every slot (out is resized to size()). Each entry is
+    // internally consistent; entries are not a cross-signal atomic cut.
+    void snapshot(std::vector<LatestValue>& out) const;
+
+    // Write "name value ts_ns updates" for every signal seen at least once.
+    void dump(std::ostream& os) const;
+
+    // Call load_state() before decoding starts (it is not seqlock-safe
+    // against a concurrent on_sample()).
+    const char* checkpoint_key() const override { return "latest_values"; }
+    void save_state(std::ostream& os) const override;
+    bool load_state(std::istream& is) override;
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> seq{0};
+        std::atomic<uint64_t> value_bits{0};
+        std::atomic<int64_t> ts_ns{0};
+        std::atomic<uint64_t> updates{0};
+    };
+
+    const SignalCatalog& cat_;
+    size_t size_ = 0;
+    std::unique_ptr<Slot[]> slots_;
+};
+
+} // namespace rbk
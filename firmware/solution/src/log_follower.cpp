@@ -0,0 +1,189 @@
+#include "log_follower.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <thread>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+namespace rbk {
+
+namespace {
+constexpr size_t kReadChunk = 1u << 20;
+}
+
+LogFollower::LogFollower(std::string path, uint64_t start_offset) : path_(std::move(path)), buf_(kReadChunk) {
+    const auto slash = path_.rfind('/');
+    const std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : path_.substr(0, slash));
+    base_ = slash == std::string::npos ? path_ : path_.substr(slash + 1);
+
+#ifdef __linux__
+    // Watch the directory, not the file: that also sees the log being
+    // recreated under the same name.
+    inotify_fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd_ >= 0) {
+        dir_wd_ = ::inotify_add_watch(inotify_fd_, dir.c_str(),
+                                      IN_MODIFY | IN_CREATE | IN_MOVED_TO | IN_CLOSE_WRITE | IN_ATTRIB);
+        if (dir_wd_ < 0) {
+            ::close(inotify_fd_);
+            inotify_fd_ = -1;
+        }
+    }
+#endif
+    reopen(start_offset);
+}
+
+LogFollower::~LogFollower() {
+    if (fd_ >= 0) ::close(fd_);
+    if (inotify_fd_ >= 0) ::close(inotify_fd_);
+}
+
+bool LogFollower::reopen(uint64_t start_offset) {
+    if (fd_ >= 0) ::close(fd_);
+    len_ = consumed_ = 0;
+    fd_ = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+        err_ = "open " + path_ + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st {};
+    ::fstat(fd_, &st);
+    inode_ = static_cast<uint64_t>(st.st_ino);
+    if (start_offset > static_cast<uint64_t>(st.st_size)) start_offset = 0;
+    if (start_offset && ::lseek(fd_, static_cast<off_t>(start_offset), SEEK_SET) < 0) start_offset = 0;
+    offset_ = read_pos_ = start_offset;
+    tail_len_ = 0;
+    const std::string t = pread_tail(fd_, start_offset);
+    push_tail(t.data(), t.size());
+    err_.clear();
+    return true;
+}
+
+std::string LogFollower::read_tail(const std::string& path, uint64_t offset) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return {};
+    std::string out = pread_tail(fd, offset);
+    ::close(fd);
+    return out;
+}
+
+std::string LogFollower::pread_tail(int fd, uint64_t offset) {
+    const size_t n = static_cast<size_t>(std::min<uint64_t>(kTailLen, offset));
+    std::string out(n, '\0');
+    if (n && ::pread(fd, &out[0], n, static_cast<off_t>(offset - n)) != static_cast<ssize_t>(n)) return {};
+    return out;
+}
+
+void LogFollower::push_tail(const char* p, size_t n) {
+    if (n >= kTailLen) {
+        std::memcpy(tail_, p + n - kTailLen, kTailLen);
+        tail_len_ = kTailLen;
+        return;
+    }
+    const size_t keep = std::min(tail_len_, kTailLen - n);
+    std::memmove(tail_, tail_ + tail_len_ - keep, keep);
+    std::memcpy(tail_ + keep, p, n);
+    tail_len_ = keep + n;
+}
+
+std::string LogFollower::tail() const {
+    const size_t from_buf = std::min(consumed_, kTailLen);
+    const size_t from_tail = std::min(tail_len_, kTailLen - from_buf);
+    std::string out(tail_ + tail_len_ - from_tail, from_tail);
+    out.append(buf_.data() + consumed_ - from_buf, from_buf);
+    return out;
+}
+
+void LogFollower::check_replaced() {
+    struct stat st {};
+    if (::stat(path_.c_str(), &st) != 0) return; // gone for now; keep the old fd
+    if (fd_ < 0 || static_cast<uint64_t>(st.st_ino) != inode_) {
+        if (fd_ >= 0) ++rotations_;
+        reopen(0);
+        return;
+    }
+    if (static_cast<uint64_t>(st.st_size) < read_pos_ || // truncated in place
+        pread_tail(fd_, offset_) != tail()) {            // ... and regrown, or a reused inode
+        ++rotations_;
+        reopen(0);
+    }
+}
+
+bool LogFollower::fill() {
+    if (fd_ < 0) return false;
+    if (len_ == buf_.size()) buf_.resize(buf_.size() * 2); // line longer than the buffer
+    for (;;) {
+        const ssize_t n = ::read(fd_, buf_.data() + len_, buf_.size() - len_);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        len_ += static_cast<size_t>(n);
+        read_pos_ += static_cast<uint64_t>(n);
+        return true;
+    }
+}
+
+void LogFollower::compact(size_t start) {
+    if (start == 0) return;
+    push_tail(buf_.data(), start);
+    std::memmove(buf_.data(), buf_.data() + start, len_ - start);
+    len_ -= start;
+    consumed_ = 0;
+}
+
+bool LogFollower::partial(std::string& out) const {
+    if (len_ == consumed_) return false;
+    out.assign(buf_.data() + consumed_, len_ - consumed_);
+    return true;
+}
+
+void LogFollower::consume_partial() {
+    push_tail(buf_.data(), len_);
+    offset_ += len_ - consumed_;
+    len_ = consumed_ = 0;
+}
+
+bool LogFollower::wait(int timeout_ms) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    for (;;) {
+        int left = -1;
+        if (timeout_ms >= 0) {
+            const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                deadline - std::chrono::steady_clock::now()).count();
+            if (ms <= 0) return false;
+            left = static_cast<int>(ms);
+        }
+
+#ifdef __linux__
+        if (inotify_fd_ >= 0) {
+            pollfd pfd{inotify_fd_, POLLIN, 0};
+            const int r = ::poll(&pfd, 1, left);
+            if (r < 0) return true;  // signal: let the caller look at its flags
+            if (r == 0) continue;    // timed out; the deadline check returns false
+            alignas(inotify_event) char ev[4096];
+            bool hit = false;
+            ssize_t n;
+            while ((n = ::read(inotify_fd_, ev, sizeof(ev))) > 0) {
+                for (char* p = ev; p < ev + n;) {
+                    const auto* e = reinterpret_cast<const inotify_event*>(p);
+                    if ((e->mask & IN_Q_OVERFLOW) || (e->len && base_ == e->name)) hit = true;
+                    p += sizeof(inotify_event) + e->len;
+                }
+            }
+            if (hit) return true;
+            continue; // other files in the directory (e.g. our own output)
+        }
+#endif
+        // No inotify: poll the file every 200 ms.
+        std::this_thread::sleep_for(std::chrono::milliseconds(left < 0 ? 200 : std::min(left, 200)));
+        return true;
+    }
+}
+
+} // namespace rbk
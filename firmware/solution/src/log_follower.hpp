@@ -0,0 +1,103 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace rbk {
+
+// Incremental reader for a log that another process keeps appending to.
+// Only complete ('\n'-terminated) lines are handed out; a partially written
+// last line stays buffered until the rest arrives. offset() is always the
+// byte just past the last line delivered, so it is safe to checkpoint.
+//
+// Growth is detected with inotify on Linux (falls back to polling). If the
+// file shrinks (truncated), its inode changes (rotated/replaced) or the last
+// bytes delivered are no longer what the file holds at that offset (truncated
+// and regrown between drains, or deleted and recreated on a reused inode),
+// reading restarts from byte 0 of the new file and rotations() is incremented.
+class LogFollower {
+public:
+    explicit LogFollower(std::string path, uint64_t start_offset = 0);
+    ~LogFollower();
+
+    LogFollower(const LogFollower&) = delete;
+    LogFollower& operator=(const LogFollower&) = delete;
+
+    bool ok() const { return fd_ >= 0; }
+    const std::string& error() const { return err_; }
+
+    // Read what was appended since the last call and invoke
+    // fn(const char* line, size_t len) for each complete line (without the
+    // '\n'), stopping after max_lines so callers can checkpoint between
+    // batches. Returns the number of lines delivered; max_lines means there
+    // may be more right away.
+    template <typename Fn>
+    size_t drain(Fn&& fn, size_t max_lines = SIZE_MAX) {
+        size_t lines = 0;
+        check_replaced();
+        do {
+            size_t start = consumed_;
+            while (lines < max_lines) {
+                const void* nl = std::memchr(buf_.data() + start, '\n', len_ - start);
+                if (!nl) break;
+                const size_t end = static_cast<size_t>(static_cast<const char*>(nl) - buf_.data());
+                fn(buf_.data() + start, end - start);
+                ++lines;
+                start = end + 1;
+                offset_ += start - consumed_;
+                consumed_ = start;
+            }
+            if (lines == max_lines) break; // the rest stays buffered
+            compact(start);
+        } while (fill());
+        return lines;
+    }
+
+    // The unterminated tail, if any (e.g. the last line of a finished file).
+    bool partial(std::string& out) const;
+    // Mark the buffered partial line as consumed.
+    void consume_partial();
+
+    // Block until the file may have changed, up to timeout_ms (-1 = forever).
+    // Returns false on timeout.
+    bool wait(int timeout_ms);
+
+    uint64_t offset() const { return offset_; }
+    uint64_t inode() const { return inode_; }
+    // Up to kTailLen bytes of the log just before offset(); a checkpoint keeps
+    // them so a resume can tell the same file from one rewritten in place.
+    std::string tail() const;
+    // The same bytes as found in the file at `path` now ("" if unreadable).
+    static std::string read_tail(const std::string& path, uint64_t offset);
+    uint64_t rotations() const { return rotations_; }
+
+private:
+    bool fill();
+    void compact(size_t start);
+    void check_replaced();
+    bool reopen(uint64_t start_offset);
+    void push_tail(const char* p, size_t n);
+    static std::string pread_tail(int fd, uint64_t offset);
+
+    static constexpr size_t kTailLen = 64;
+
+    std::string path_;
+    std::string base_;        // file name inside the watched directory
+    std::string err_;
+    int fd_ = -1;
+    int inotify_fd_ = -1;
+    int dir_wd_ = -1;
+    uint64_t inode_ = 0;
+    uint64_t offset_ = 0;     // log offset of buf_[0] + consumed_
+    uint64_t read_pos_ = 0;   // log offset of buf_[len_]
+    uint64_t rotations_ = 0;
+    std::vector<char> buf_;
+    size_t len_ = 0;          // valid bytes in buf_
+    size_t consumed_ = 0;     // bytes of buf_ already delivered
+    char tail_[kTailLen];     // last bytes of the log before buf_[0]
+    size_t tail_len_ = 0;
+};
+
+} // namespace rbk
@@ -0,0 +1,233 @@
+#include "range_check.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <istream>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RBK_RANGE_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define RBK_RANGE_NEON 1
+#endif
+
+namespace rbk {
+
+bool parse_range_policy(const std::string& s, RangePolicy& out) {
+    if (s == "count") out = RangePolicy::Count;
+    else if (s == "flag") out = RangePolicy::Flag;
+    else if (s == "clamp") out = RangePolicy::Clamp;
+    else if (s == "drop") out = RangePolicy::Drop;
+    else return false;
+    return true;
+}
+
+const char* to_string(RangePolicy p) {
+    switch (p) {
+    case RangePolicy::Count: return "count";
+    case RangePolicy::Flag: return "flag";
+    case RangePolicy::Clamp: return "clamp";
+    case RangePolicy::Drop: return "drop";
+    }
+    return "?";
+}
+
+RangeFilter::RangeFilter(const SignalCatalog& cat, SampleSink& next, RangePolicy def)
+    : cat_(cat), next_(next), lo_(cat.size(), -std::numeric_limits<double>::infinity()),
+      hi_(cat.size(), std::numeric_limits<double>::infinity()), limited_(cat.size(), 0),
+      policy_(cat.size(), def), stats_(cat.size()) {
+    for (uint32_t i = 0; i < cat.size(); ++i) {
+        const dbcppp::ISignal* sig = cat.info(i).sig;
+        if (!sig) continue;
+        const double mn = sig->Minimum();
+        const double mx = sig->Maximum();
+        if (!(mn < mx)) continue; // [0|0] means "no limits" in every DBC we get
+        lo_[i] = mn;
+        hi_[i] = mx;
+        limited_[i] = 1;
+    }
+}
+
+bool RangeFilter::set_policy(const std::string& name, RangePolicy p) {
+    bool found = false;
+    for (uint32_t i = 0; i < cat_.size(); ++i) {
+        if (cat_.info(i).name == name) {
+            policy_[i] = p;
+            found = true;
+        }
+    }
+    return found;
+}
+
+size_t RangeFilter::limited_signals() const {
+    return static_cast<size_t>(std::count(limited_.begin(), limited_.end(), uint8_t{1}));
+}
+
+void RangeFilter::begin_frame(const ParsedLine& pl, uint8_t bus) {
+    n_ = 0;
+    next_.begin_frame(pl, bus);
+}
+
+void RangeFilter::on_sample(const Sample& s) {
+    if (n_ == kBatch) flush_batch();
+    vals_[n_] = s.value;
+    blo_[n_] = lo_[s.signal];
+    bhi_[n_] = hi_[s.signal];
+    batch_[n_] = s;
+    ++n_;
+}
+
+void RangeFilter::end_frame() {
+    flush_batch();
+    next_.end_frame();
+}
+
+void RangeFilter::flush_batch() {
+    // bit i set = sample i failed lo <= v <= hi (NaN fails both compares)
+    uint64_t bad = 0;
+    size_t i = 0;
+#if defined(RBK_RANGE_SSE2)
+    for (; i + 2 <= n_; i += 2) {
+        const __m128d v = _mm_load_pd(vals_ + i);
+        const __m128d ok = _mm_and_pd(_mm_cmpge_pd(v, _mm_load_pd(blo_ + i)), _mm_cmple_pd(v, _mm_load_pd(bhi_ + i)));
+        bad |= static_cast<uint64_t>(~_mm_movemask_pd(ok) & 3) << i;
+    }
+#elif defined(RBK_RANGE_NEON)
+    for (; i + 2 <= n_; i += 2) {
+        const float64x2_t v = vld1q_f64(vals_ + i);
+        const uint64x2_t ok = vandq_u64(vcgeq_f64(v, vld1q_f64(blo_ + i)), vcleq_f64(v, vld1q_f64(bhi_ + i)));
+        bad |= static_cast<uint64_t>(vgetq_lane_u64(ok, 0) == 0) << i;
+        bad |= static_cast<uint64_t>(vgetq_lane_u64(ok, 1) == 0) << (i + 1);
+    }
+#endif
+    for (; i < n_; ++i) {
+        bad |= static_cast<uint64_t>(!(vals_[i] >= blo_[i] && vals_[i] <= bhi_[i])) << i;
+    }
+    checked_ += n_;
+
+    if (!bad) {
+        for (size_t k = 0; k < n_; ++k) next_.on_sample(batch_[k]);
+    } else {
+        for (size_t k = 0; k < n_; ++k) {
+            if ((bad >> k) & 1) {
+                handle_violation(batch_[k]);
+            } else {
+                next_.on_sample(batch_[k]);
+            }
+        }
+    }
+    n_ = 0;
+}
+
+void RangeFilter::handle_violation(Sample s) {
+    const uint32_t idx = s.signal;
+    if (!limited_[idx]) { // NaN on an unchecked signal
+        next_.on_sample(s);
+        return;
+    }
+
+    RangeViolations& v = stats_[idx];
+    const bool below = s.value < lo_[idx];
+    if (v.total() == 0) {
+        v.first_ns = s.ts_ns;
+        v.lowest = v.highest = s.value;
+    }
+    v.last_ns = s.ts_ns;
+    if (below) {
+        ++v.below;
+        v.lowest = std::min(v.lowest, s.value);
+    } else {
+        ++v.above;
+        if (!(s.value <= v.highest)) v.highest = s.value; // keeps NaN visible
+    }
+    ++violations_;
+
+    switch (policy_[idx]) {
+    case RangePolicy::Count:
+        break;
+    case RangePolicy::Flag:
+        s.flags |= kSampleOutOfRange;
+        break;
+    case RangePolicy::Clamp:
+        s.value = (below || std::isnan(s.value)) ? lo_[idx] : hi_[idx];
+        break;
+    case RangePolicy::Drop:
+        ++dropped_;
+        return;
+    }
+    next_.on_sample(s);
+}
+
+void RangeFilter::write_summary(std::ostream& os) const {
+    std::vector<uint32_t> hit;
+    for (uint32_t i = 0; i < stats_.size(); ++i) {
+        if (stats_[i].total()) hit.push_back(i);
+    }
+    std::sort(hit.begin(), hit.end(), [&](uint32_t a, uint32_t b) {
+        return stats_[a].total() != stats_[b].total() ? stats_[a].total() > stats_[b].total() : a < b;
+    });
+
+    os << std::left << std::setw(4) << "bus" << std::setw(11) << "id" << std::setw(34) << "signal"
+       << std::right << std::setw(12) << "min" << std::setw(12) << "max" << std::setw(8) << "policy"
+       << std::setw(10) << "below" << std::setw(10) << "above" << std::setw(14) << "lowest"
+       << std::setw(14) << "highest" << "\n";
+    for (uint32_t i : hit) {
+        const SignalInfo& si = cat_.info(i);
+        const RangeViolations& v = stats_[i];
+        char id[16];
+        std::snprintf(id, sizeof(id), "0x%X", si.can_id);
+        os << std::left << std::setw(4) << int(si.bus) << std::setw(11) << id << std::setw(34) << si.name
+           << std::right << std::setprecision(6) << std::setw(12) << lo_[i] << std::setw(12) << hi_[i]
+           << std::setw(8) << to_string(policy_[i]) << std::setw(10) << v.below << std::setw(10) << v.above
+           << std::setw(14);
+        if (v.below) os << v.lowest; else os << "-";
+        os << std::setw(14);
+        if (v.above) os << v.highest; else os << "-";
+        os << "\n";
+    }
+    os << "checked " << checked_ << " samples, " << violations_ << " out of range on " << hit.size()
+       << " signals, dropped " << dropped_ << "\n";
+}
+
+void RangeFilter::save_state(std::ostream& os) const {
+    os << "signals " << stats_.size() << ' ' << checked_ << ' ' << violations_ << ' ' << dropped_ << "\n";
+    for (size_t i = 0; i < stats_.size(); ++i) {
+        const RangeViolations& v = stats_[i];
+        if (!v.total()) continue;
+        os << i << ' ' << v.below << ' ' << v.above << ' ';
+        put_double(os, v.lowest);
+        os << ' ';
+        put_double(os, v.highest);
+        os << ' ' << v.first_ns << ' ' << v.last_ns << "\n";
+    }
+}
+
+bool RangeFilter::load_state(std::istream& is) {
+    std::string tag;
+    size_t n = 0;
+    uint64_t checked = 0, violations = 0, dropped = 0;
+    if (!(is >> tag >> n >> checked >> violations >> dropped) || tag != "signals" || n != stats_.size()) {
+        return false;
+    }
+    std::vector<RangeViolations> stats(n);
+    size_t idx;
+    while (is >> idx) {
+        if (idx >= n) return false;
+        RangeViolations& v = stats[idx];
+        is >> v.below >> v.above;
+        get_double(is, v.lowest);
+        get_double(is, v.highest);
+        is >> v.first_ns >> v.last_ns;
+        if (!is) return false;
+    }
+    stats_ = std::move(stats);
+    checked_ = checked;
+    violations_ = violations;
+    dropped_ = dropped;
+    return true;
+}
+
+} // namespace rbk
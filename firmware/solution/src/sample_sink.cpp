@@ -0,0 +1,79 @@
+#include "sample_sink.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace rbk {
+
+void TextSink::on_sample(const Sample& s) {
+    if (s.signal >= tails_.size()) tails_.resize(cat_.size());
+
+    Tail& t = tails_[s.signal];
+    uint64_t bits;
+    std::memcpy(&bits, &s.value, sizeof(bits));
+    if (t.valid && t.bits == bits) {
+        ++reused_;
+    } else {
+        // %.15g is what operator<< produces with setprecision(15) and the
+        // default floatfield.
+        char val[32];
+        const int n = std::snprintf(val, sizeof(val), "%.15g", s.value);
+        const std::string& name = cat_.info(s.signal).name;
+        t.text.clear();
+        t.text.reserve(name.size() + static_cast<size_t>(n) + 6);
+        t.text.append("): ").append(name).append(": ").append(val, static_cast<size_t>(n)).push_back('\n');
+        t.bits = bits;
+        t.valid = true;
+        ++rendered_;
+    }
+
+    // Every sample of a frame shares its timestamp.
+    if (!ts_valid_ || s.ts_ns != ts_ns_) {
+        ts_[0] = '(';
+        ts_len_ = 1 + format_timestamp(s.ts_ns, ts_ + 1);
+        ts_ns_ = s.ts_ns;
+        ts_valid_ = true;
+    }
+    os_.write(ts_, static_cast<std::streamsize>(ts_len_));
+    if (s.flags & kSampleOutOfRange) {
+        os_.write(t.text.data(), static_cast<std::streamsize>(t.text.size() - 1));
+        os_.write(" [out of range]\n", 16);
+    } else {
+        os_.write(t.text.data(), static_cast<std::streamsize>(t.text.size()));
+    }
+}
+
+size_t decode_frame(const ParsedLine& pl, uint8_t bus, const SignalCatalog& cat, SampleSink& sink) {
+    const CatalogMessage* cm = cat.find(bus, pl.can_id);
+    if (!cm) return 0;
+
+    const dbcppp::IMessage* msg = cm->msg;
+
+    uint8_t data_buf[64] = {0};
+    const size_t ncopy = std::min(pl.data.size(), sizeof(data_buf));
+    if (ncopy > 0) std::memcpy(data_buf, pl.data.data(), ncopy);
+
+    const dbcppp::ISignal* mux_sig = msg->MuxSignal();
+    const auto mux_val = mux_sig ? mux_sig->Decode(data_buf) : 0;
+
+    sink.begin_frame(pl, bus);
+    size_t wrote = 0;
+    uint32_t index = cm->first_signal;
+    for (const dbcppp::ISignal& sig : msg->Signals()) {
+        const uint32_t this_index = index++;
+        if (sig.MultiplexerIndicator() == dbcppp::ISignal::EMultiplexer::MuxValue) {
+            if (!mux_sig || mux_val != sig.MultiplexerSwitchValue()) continue;
+        }
+
+        Sample s;
+        s.ts_ns = pl.ts_ns;
+        s.signal = this_index;
+        s.value = sig.RawToPhys(sig.Decode(data_buf));
+        sink.on_sample(s);
+        ++wrote;
+    }
+    sink.end_frame();
+    return wrote;
+}
+
+} // namespace rbk
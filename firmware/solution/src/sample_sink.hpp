@@ -0,0 +1,90 @@
+#pragma once
+#include "can_decode.hpp"
+#include "signal_catalog.hpp"
+#include "timestamp.hpp"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace rbk {
+
+// Sample::flags bits.
+// TextSink, JsonPublisher and ShmPublisher pass them on; sinks that keep
+// values (latest values, history, triggers) ignore them.
+constexpr uint32_t kSampleOutOfRange = 1u << 0; // outside the DBC [min|max] (RangePolicy::Flag)
+
+// One decoded physical value. `signal` is a SignalCatalog index.
+struct Sample {
+    int64_t ts_ns = 0;
+    uint32_t signal = 0;
+    uint32_t flags = 0;
+    double value = 0.0;
+};
+
+// Consumer of decoded samples. decode_frame() calls begin_frame() once per
+// known frame, on_sample() for each signal taken, then end_frame().
+class SampleSink {
+public:
+    virtual ~SampleSink() = default;
+    virtual void begin_frame(const ParsedLine& /*pl*/, uint8_t /*bus*/) {}
+    virtual void on_sample(const Sample& s) = 0;
+    virtual void end_frame() {}
+};
+
+// Fans one decode pass out to several sinks (not owned).
+class SinkList : public SampleSink {
+public:
+    void add(SampleSink* sink) { sinks_.push_back(sink); }
+    bool empty() const { return sinks_.empty(); }
+
+    void begin_frame(const ParsedLine& pl, uint8_t bus) override {
+        for (auto* s : sinks_) s->begin_frame(pl, bus);
+    }
+    void on_sample(const Sample& smp) override {
+        for (auto* s : sinks_) s->on_sample(smp);
+    }
+    void end_frame() override {
+        for (auto* s : sinks_) s->end_frame();
+    }
+
+private:
+    std::vector<SampleSink*> sinks_;
+};
+
+// Writes the output.txt format: "(timestamp): SignalName: value", with
+// " [out of range]" appended to flagged samples.
+// The "): SignalName: value\n" tail is rendered once per signal and reused
+// until that signal's value changes (compared bitwise); the "(timestamp"
+// head is rendered once per frame.
+class TextSink : public SampleSink {
+public:
+    TextSink(const SignalCatalog& cat, std::ostream& os) : cat_(cat), os_(os), tails_(cat.size()) {}
+    void on_sample(const Sample& s) override;
+
+    uint64_t rendered() const { return rendered_; }
+    uint64_t reused() const { return reused_; }
+
+private:
+    struct Tail {
+        bool valid = false;
+        uint64_t bits = 0;
+        std::string text;
+    };
+
+    const SignalCatalog& cat_;
+    std::ostream& os_;
+    std::vector<Tail> tails_;
+    bool ts_valid_ = false;
+    int64_t ts_ns_ = 0;
+    size_t ts_len_ = 0;
+    char ts_[kTimestampBufLen + 1];
+    uint64_t rendered_ = 0;
+    uint64_t reused_ = 0;
+};
+
+// Decode one frame through the catalog and feed every taken signal to `sink`.
+// Returns number of samples emitted (0 for unknown IDs).
+size_t decode_frame(const ParsedLine& pl, uint8_t bus, const SignalCatalog& cat, SampleSink& sink);
+
+} // namespace rbk
@@ -0,0 +1,233 @@
+#include "shm_ring.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace rbk {
+
+static uint32_t round_pow2(uint32_t v) {
+    uint32_t p = 1;
+    while (p < v && p < (1u << 30)) p <<= 1;
+    return p;
+}
+
+static uint64_t align_up(uint64_t v, uint64_t a) {
+    return (v + a - 1) / a * a;
+}
+
+// ------------------ producer ------------------
+ShmPublisher::ShmPublisher(const SignalCatalog& cat, ShmConfig cfg) : cfg_(std::move(cfg)) {
+    const uint32_t cap = round_pow2(cfg_.ring_capacity ? cfg_.ring_capacity : 1);
+    mask_ = cap - 1;
+    ring_count_ = static_cast<uint32_t>(cat.bus_count());
+
+    const uint64_t dir_off = align_up(sizeof(ShmHeader), 64);
+    rings_offset_ = align_up(dir_off + sizeof(ShmDirEntry) * cat.size(), 64);
+    stride_ = align_up(sizeof(ShmRingHeader) + sizeof(ShmRecord) * cap, 64);
+    size_ = static_cast<size_t>(rings_offset_ + stride_ * ring_count_);
+
+    // Never resize a region in place: a reader still mapping the previous
+    // run's segment would take SIGBUS past the new end. Unlinking leaves its
+    // mapping intact (just frozen) and the new region starts from zeroes.
+    if (::shm_unlink(cfg_.name.c_str()) != 0 && errno != ENOENT) {
+        err_ = "shm_unlink " + cfg_.name + ": " + std::strerror(errno);
+        return;
+    }
+    const int fd = ::shm_open(cfg_.name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        err_ = "shm_open " + cfg_.name + ": " + std::strerror(errno);
+        return;
+    }
+    if (::ftruncate(fd, static_cast<off_t>(size_)) != 0) {
+        err_ = "ftruncate " + cfg_.name + ": " + std::strerror(errno);
+        ::close(fd);
+        ::shm_unlink(cfg_.name.c_str());
+        return;
+    }
+    void* p = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        err_ = "mmap " + cfg_.name + ": " + std::strerror(errno);
+        ::shm_unlink(cfg_.name.c_str());
+        return;
+    }
+    base_ = static_cast<uint8_t*>(p);
+
+    // Directory first, header magic last, so readers never see a partial layout.
+    auto* dir = reinterpret_cast<ShmDirEntry*>(base_ + dir_off);
+    for (uint32_t i = 0; i < cat.size(); ++i) {
+        const SignalInfo& si = cat.info(i);
+        dir[i].index = i;
+        dir[i].can_id = si.can_id;
+        dir[i].bus = si.bus;
+        std::strncpy(dir[i].name, si.name.c_str(), kShmNameLen - 1);
+        dir[i].name[kShmNameLen - 1] = '\0';
+    }
+
+    auto* hdr = reinterpret_cast<ShmHeader*>(base_);
+    hdr->version = kShmVersion;
+    hdr->ring_count = ring_count_;
+    hdr->ring_capacity = cap;
+    hdr->signal_count = static_cast<uint32_t>(cat.size());
+    hdr->directory_offset = dir_off;
+    hdr->rings_offset = rings_offset_;
+    hdr->ring_stride = stride_;
+    hdr->total_size = size_;
+    hdr->magic.store(kShmMagic, std::memory_order_release);
+}
+
+ShmPublisher::~ShmPublisher() {
+    if (!base_) return;
+    ::munmap(base_, size_);
+    if (cfg_.unlink_on_exit) ::shm_unlink(cfg_.name.c_str());
+}
+
+void ShmPublisher::begin_frame(const ParsedLine& /*pl*/, uint8_t bus) {
+    if (!base_ || bus >= ring_count_) {
+        ring_ = nullptr;
+        return;
+    }
+    uint8_t* r = base_ + rings_offset_ + stride_ * bus;
+    ring_ = reinterpret_cast<ShmRingHeader*>(r);
+    records_ = reinterpret_cast<ShmRecord*>(r + sizeof(ShmRingHeader));
+    head_ = ring_->head.load(std::memory_order_relaxed);
+}
+
+void ShmPublisher::on_sample(const Sample& s) {
+    if (!ring_) return;
+    ShmRecord& rec = records_[head_ & mask_];
+
+    uint64_t bits;
+    std::memcpy(&bits, &s.value, sizeof(bits));
+
+    rec.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    rec.ts_ns.store(s.ts_ns, std::memory_order_relaxed);
+    rec.value_bits.store(bits, std::memory_order_relaxed);
+    rec.signal.store(s.signal, std::memory_order_relaxed);
+    rec.flags.store(s.flags, std::memory_order_relaxed);
+    rec.seq.store(head_ + 1, std::memory_order_release);
+
+    ++head_;
+    ring_->head.store(head_, std::memory_order_release);
+}
+
+// ------------------ consumer ------------------
+ShmReader::~ShmReader() {
+    detach();
+}
+
+bool ShmReader::attach(const std::string& name, std::string* err) {
+    detach();
+    const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        if (err) *err = "shm_open " + name + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(ShmHeader)) {
+        if (err) *err = "region " + name + " too small";
+        ::close(fd);
+        return false;
+    }
+    void* p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        if (err) *err = "mmap " + name + ": " + std::strerror(errno);
+        return false;
+    }
+    base_ = static_cast<const uint8_t*>(p);
+    size_ = static_cast<size_t>(st.st_size);
+    hdr_ = reinterpret_cast<const ShmHeader*>(base_);
+
+    if (hdr_->magic.load(std::memory_order_acquire) != kShmMagic || hdr_->version != kShmVersion ||
+        hdr_->total_size > size_) {
+        if (err) *err = "region " + name + " not initialised or incompatible";
+        detach();
+        return false;
+    }
+    dir_ = reinterpret_cast<const ShmDirEntry*>(base_ + hdr_->directory_offset);
+
+    cursor_.assign(hdr_->ring_count, 0);
+    for (uint32_t r = 0; r < hdr_->ring_count; ++r) {
+        const uint64_t head = ring_header(r)->head.load(std::memory_order_acquire);
+        cursor_[r] = head > hdr_->ring_capacity ? head - hdr_->ring_capacity : 0;
+    }
+    lost_ = 0;
+    return true;
+}
+
+void ShmReader::detach() {
+    if (base_) ::munmap(const_cast<uint8_t*>(base_), size_);
+    base_ = nullptr;
+    hdr_ = nullptr;
+    dir_ = nullptr;
+    size_ = 0;
+    cursor_.clear();
+}
+
+int64_t ShmReader::find_signal(const std::string& name) const {
+    for (uint32_t i = 0; i < signal_count(); ++i) {
+        if (name == dir_[i].name) return i;
+    }
+    return -1;
+}
+
+void ShmReader::seek_to_latest() {
+    for (uint32_t r = 0; r < ring_count(); ++r) {
+        cursor_[r] = ring_header(r)->head.load(std::memory_order_acquire);
+    }
+}
+
+const ShmRingHeader* ShmReader::ring_header(uint32_t r) const {
+    return reinterpret_cast<const ShmRingHeader*>(base_ + hdr_->rings_offset + hdr_->ring_stride * r);
+}
+
+const ShmRecord* ShmReader::ring_records(uint32_t r) const {
+    return reinterpret_cast<const ShmRecord*>(reinterpret_cast<const uint8_t*>(ring_header(r)) +
+                                              sizeof(ShmRingHeader));
+}
+
+bool ShmReader::next(uint32_t ring, ShmSample& out) {
+    if (!hdr_ || ring >= hdr_->ring_count) return false;
+    const uint64_t cap = hdr_->ring_capacity;
+    const ShmRecord* recs = ring_records(ring);
+    uint64_t& cur = cursor_[ring];
+
+    for (;;) {
+        const uint64_t head = ring_header(ring)->head.load(std::memory_order_acquire);
+        if (cur >= head) return false;
+        if (head - cur > cap) {
+            // lapped: jump to the oldest record that can still be intact
+            lost_ += head - cap - cur;
+            cur = head - cap;
+        }
+
+        const ShmRecord& rec = recs[cur & (cap - 1)];
+        const uint64_t s1 = rec.seq.load(std::memory_order_acquire);
+        const int64_t ts = rec.ts_ns.load(std::memory_order_relaxed);
+        const uint64_t bits = rec.value_bits.load(std::memory_order_relaxed);
+        const uint32_t sig = rec.signal.load(std::memory_order_relaxed);
+        const uint32_t flags = rec.flags.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t s2 = rec.seq.load(std::memory_order_relaxed);
+
+        if (s1 == cur + 1 && s2 == s1) {
+            out.seq = cur;
+            out.ts_ns = ts;
+            out.signal = sig;
+            out.flags = flags;
+            std::memcpy(&out.value, &bits, sizeof(bits));
+            ++cur;
+            return true;
+        }
+        // Overwritten (or being overwritten) while we looked: skip it.
+        ++lost_;
+        ++cur;
+    }
+}
+
+} // namespace rbk
@@ -0,0 +1,149 @@
+#pragma once
+#include "sample_sink.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rbk {
+
+// ---------- Shared-memory layout (version 1) ----------
+//
+//   ShmHeader
+//   ShmDirEntry[signal_count]             signal-name directory
+//   { ShmRingHeader, ShmRecord[capacity] }[ring_count]    one ring per bus
+//
+// Every ring is a single-producer broadcast ring: the decoder never waits
+// for readers, readers keep their own cursor and detect being lapped through
+// the per-record sequence number (seqlock style).
+
+constexpr uint32_t kShmMagic = 0x534B4252; // "RBKS"
+constexpr uint32_t kShmVersion = 1;
+constexpr size_t kShmNameLen = 52;
+
+struct ShmHeader {
+    std::atomic<uint32_t> magic;   // written last; readers wait for it
+    uint32_t version;
+    uint32_t ring_count;
+    uint32_t ring_capacity;        // records per ring, power of two
+    uint32_t signal_count;
+    uint32_t reserved;
+    uint64_t directory_offset;
+    uint64_t rings_offset;
+    uint64_t ring_stride;          // bytes per ring incl. header
+    uint64_t total_size;
+};
+
+struct ShmDirEntry {
+    uint32_t index;
+    uint32_t can_id;
+    uint8_t bus;
+    uint8_t pad[3];
+    char name[kShmNameLen];        // NUL-terminated, truncated if longer
+};
+static_assert(sizeof(ShmDirEntry) == 64, "directory entry must stay 64 bytes");
+
+struct alignas(64) ShmRingHeader {
+    std::atomic<uint64_t> head;    // records ever written to this ring
+};
+
+struct ShmRecord {
+    std::atomic<uint64_t> seq;     // position + 1 once complete, 0 while writing
+    std::atomic<int64_t> ts_ns;
+    std::atomic<uint64_t> value_bits;
+    std::atomic<uint32_t> signal;
+    std::atomic<uint32_t> flags;   // Sample::flags (kSampleOutOfRange)
+};
+static_assert(sizeof(ShmRecord) == 32, "records must stay 32 bytes");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared atomics must be lock-free");
+
+// One decoded record as seen by a reader.
+struct ShmSample {
+    uint64_t seq = 0;
+    int64_t ts_ns = 0;
+    uint32_t signal = 0;
+    uint32_t flags = 0;
+    double value = 0.0;
+};
+
+// ---------- Producer ----------
+struct ShmConfig {
+    std::string name = "/rbk_decoded";   // shm_open name
+    uint32_t ring_capacity = 1u << 16;   // rounded up to a power of two
+    bool unlink_on_exit = true;
+};
+
+// Publishes decoded samples into a POSIX shared-memory region, one ring per bus.
+// An existing region of the same name is unlinked and replaced, not resized;
+// readers attached to it keep a valid (stale) mapping and re-attach to follow.
+class ShmPublisher : public SampleSink {
+public:
+    ShmPublisher(const SignalCatalog& cat, ShmConfig cfg);
+    ~ShmPublisher() override;
+
+    ShmPublisher(const ShmPublisher&) = delete;
+    ShmPublisher& operator=(const ShmPublisher&) = delete;
+
+    bool ok() const { return base_ != nullptr; }
+    const std::string& error() const { return err_; }
+
+    void begin_frame(const ParsedLine& pl, uint8_t bus) override;
+    void on_sample(const Sample& s) override;
+
+private:
+    ShmConfig cfg_;
+    std::string err_;
+    uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+    uint32_t mask_ = 0;
+    uint64_t stride_ = 0;
+    uint64_t rings_offset_ = 0;
+    uint32_t ring_count_ = 0;
+    ShmRingHeader* ring_ = nullptr;  // ring of the current frame
+    ShmRecord* records_ = nullptr;
+    uint64_t head_ = 0;              // local copy of ring_->head
+};
+
+// ---------- Consumer ----------
+// Attaches read-only and follows every ring with a private cursor. No
+// syscalls after attach(); next() is a handful of loads per record.
+class ShmReader {
+public:
+    ShmReader() = default;
+    ~ShmReader();
+
+    ShmReader(const ShmReader&) = delete;
+    ShmReader& operator=(const ShmReader&) = delete;
+
+    // Map the region. Cursors start at the oldest record still in each ring.
+    bool attach(const std::string& name, std::string* err = nullptr);
+    void detach();
+
+    uint32_t ring_count() const { return hdr_ ? hdr_->ring_count : 0; }
+    uint32_t signal_count() const { return hdr_ ? hdr_->signal_count : 0; }
+    const ShmDirEntry& signal(uint32_t index) const { return dir_[index]; }
+    int64_t find_signal(const std::string& name) const;
+
+    // Skip everything already published; only new records are returned.
+    void seek_to_latest();
+
+    // Next record from `ring`; false when caught up. Records overwritten
+    // before they were read are counted in lost().
+    bool next(uint32_t ring, ShmSample& out);
+
+    uint64_t lost() const { return lost_; }
+
+private:
+    const ShmRingHeader* ring_header(uint32_t r) const;
+    const ShmRecord* ring_records(uint32_t r) const;
+
+    const uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+    const ShmHeader* hdr_ = nullptr;
+    const ShmDirEntry* dir_ = nullptr;
+    std::vector<uint64_t> cursor_;
+    uint64_t lost_ = 0;
+};
+
+} // namespace rbk
@@ -0,0 +1,41 @@
+#include "signal_catalog.hpp"
+
+namespace rbk {
+
+uint8_t SignalCatalog::add_bus(const dbcppp::INetwork& net) {
+    const uint8_t bus = static_cast<uint8_t>(buses_.size());
+    buses_.emplace_back();
+    auto& msgs = buses_.back();
+
+    for (const dbcppp::IMessage& msg : net.Messages()) {
+        CatalogMessage cm;
+        cm.msg = &msg;
+        cm.first_signal = static_cast<uint32_t>(signals_.size());
+        for (const dbcppp::ISignal& sig : msg.Signals()) {
+            SignalInfo si;
+            si.name = sig.Name();
+            si.bus = bus;
+            si.can_id = static_cast<uint32_t>(msg.Id());
+            si.sig = &sig;
+            by_name_.emplace(si.name, static_cast<uint32_t>(signals_.size()));
+            signals_.push_back(std::move(si));
+        }
+        cm.index = static_cast<uint32_t>(message_count_);
+        if (msgs.emplace(static_cast<uint32_t>(msg.Id()), cm).second) ++message_count_;
+    }
+    return bus;
+}
+
+int64_t SignalCatalog::index_of(const std::string& name) const {
+    auto it = by_name_.find(name);
+    return it == by_name_.end() ? -1 : static_cast<int64_t>(it->second);
+}
+
+int64_t SignalCatalog::index_of(uint8_t bus, const std::string& name) const {
+    for (size_t i = 0; i < signals_.size(); ++i) {
+        if (signals_[i].bus == bus && signals_[i].name == name) return static_cast<int64_t>(i);
+    }
+    return -1;
+}
+
+} // namespace rbk
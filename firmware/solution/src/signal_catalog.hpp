@@ -0,0 +1,57 @@
+#pragma once
+#include <dbcppp/Network.h>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rbk {
+
+// One decodable signal, identified across all buses by its catalog index.
+struct SignalInfo {
+    std::string name;
+    uint8_t bus = 0;
+    uint32_t can_id = 0;
+    const dbcppp::ISignal* sig = nullptr;
+};
+
+// Message entry: signals of `msg` occupy consecutive catalog indices starting
+// at `first_signal`, in msg->Signals() order. `index` is dense across all
+// buses (< message_count()) for per-message side tables.
+struct CatalogMessage {
+    const dbcppp::IMessage* msg = nullptr;
+    uint32_t first_signal = 0;
+    uint32_t index = 0;
+};
+
+// Flat signal index over every loaded bus. Bus indices are assigned in
+// add_bus() order; the networks must outlive the catalog.
+class SignalCatalog {
+public:
+    // Register all messages of `net`; returns the new bus index.
+    uint8_t add_bus(const dbcppp::INetwork& net);
+
+    const CatalogMessage* find(uint8_t bus, uint32_t can_id) const {
+        if (bus >= buses_.size()) return nullptr;
+        auto it = buses_[bus].find(can_id);
+        return it == buses_[bus].end() ? nullptr : &it->second;
+    }
+
+    size_t size() const { return signals_.size(); }
+    size_t bus_count() const { return buses_.size(); }
+    size_t message_count() const { return message_count_; }
+    const SignalInfo& info(uint32_t index) const { return signals_[index]; }
+
+    // Index of the first signal called `name` (lowest bus wins), or -1.
+    int64_t index_of(const std::string& name) const;
+    // Index of `name` on a specific bus, or -1.
+    int64_t index_of(uint8_t bus, const std::string& name) const;
+
+private:
+    std::vector<SignalInfo> signals_;
+    std::vector<std::unordered_map<uint32_t, CatalogMessage>> buses_;
+    std::unordered_map<std::string, uint32_t> by_name_;
+    size_t message_count_ = 0;
+};
+
+} // namespace rbk
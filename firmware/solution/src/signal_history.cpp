@@ -0,0 +1,256 @@
+#include "signal_history.hpp"
+#include <cstring>
+#include <iomanip>
+
+namespace rbk {
+
+namespace {
+
+// Worst case per sample: 69 timestamp bits + 2 + 5 + 6 + 64 value bits.
+constexpr uint32_t kMaxSampleBits = 69 + 77;
+
+inline uint64_t low_bits(uint64_t v, unsigned n) { return n >= 64 ? v : v & ((uint64_t{1} << n) - 1); }
+
+// Append the low n (1..64) bits of v, most significant first.
+inline void put(uint64_t* words, uint32_t& pos, uint64_t v, unsigned n) {
+    v = low_bits(v, n);
+    uint64_t& w = words[pos >> 6];
+    const unsigned room = 64 - (pos & 63);
+    if (n <= room) {
+        w |= v << (room - n);
+    } else {
+        w |= v >> (n - room);
+        words[(pos >> 6) + 1] |= v << (64 - (n - room));
+    }
+    pos += n;
+}
+
+class BitReader {
+public:
+    explicit BitReader(const uint64_t* words) : words_(words) {}
+
+    uint64_t get(unsigned n) {
+        const uint64_t w = words_[pos_ >> 6];
+        const unsigned room = 64 - (pos_ & 63);
+        uint64_t v;
+        if (n <= room) {
+            v = w >> (room - n);
+        } else {
+            v = (w << (n - room)) | (words_[(pos_ >> 6) + 1] >> (64 - (n - room)));
+        }
+        pos_ += n;
+        return low_bits(v, n);
+    }
+    bool bit() { return get(1) != 0; }
+
+private:
+    const uint64_t* words_;
+    uint32_t pos_ = 0;
+};
+
+inline int64_t sign_extend(uint64_t v, unsigned n) {
+    const unsigned shift = 64 - n;
+    return static_cast<int64_t>(v << shift) >> shift;
+}
+
+inline unsigned clz64(uint64_t x) { return static_cast<unsigned>(__builtin_clzll(x)); }
+inline unsigned ctz64(uint64_t x) { return static_cast<unsigned>(__builtin_ctzll(x)); }
+
+} // namespace
+
+SignalHistory::SignalHistory(const SignalCatalog& cat, HistoryConfig cfg)
+    : cat_(cat), cfg_(cfg), series_(cat.size()) {
+    if (cfg_.ts_unit_ns < 1) cfg_.ts_unit_ns = 1;
+    retention_units_ = cfg_.retention_ns / cfg_.ts_unit_ns;
+}
+
+SignalHistory::~SignalHistory() = default;
+
+SignalHistory::Chunk* SignalHistory::new_chunk() {
+    Chunk* c;
+    if (!free_.empty()) {
+        c = free_.back();
+        free_.pop_back();
+    } else {
+        owned_.push_back(std::make_unique<Chunk>());
+        c = owned_.back().get();
+    }
+    std::memset(c->words, 0, sizeof(c->words));
+    c->count = 0;
+    c->bits = 0;
+    return c;
+}
+
+void SignalHistory::ChunkRing::push_back(Chunk* c) {
+    if (count == slots.size()) {
+        std::vector<Chunk*> grown(slots.empty() ? 4 : slots.size() * 2);
+        for (size_t i = 0; i < count; ++i) grown[i] = at(i);
+        slots.swap(grown);
+        head = 0;
+    }
+    slots[(head + count) & (slots.size() - 1)] = c;
+    ++count;
+}
+
+void SignalHistory::retire_old(Series& s) {
+    // The open chunk goes too once the signal has gone quiet; the next sample
+    // starts a fresh one.
+    const int64_t cutoff = newest_ - retention_units_;
+    while (!s.chunks.empty() && s.chunks.front()->max_ts < cutoff) {
+        free_.push_back(s.chunks.front());
+        s.chunks.pop_front();
+    }
+}
+
+void SignalHistory::retire_old() {
+    since_sweep_ = 0;
+    for (Series& s : series_) retire_old(s);
+}
+
+void SignalHistory::append(uint32_t signal, int64_t ts_ns, double value) {
+    if (signal >= series_.size()) return;
+    if (++since_sweep_ >= kSweepAppends) retire_old();
+    Series& s = series_[signal];
+    const int64_t ts = ts_ns / cfg_.ts_unit_ns;
+    if (ts > newest_) newest_ = ts;
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    Chunk* c = s.chunks.empty() ? nullptr : s.chunks.back();
+    if (!c || c->bits + kMaxSampleBits > kChunkBits) {
+        // Seal the open chunk (if any); the new one starts with a raw sample.
+        c = new_chunk();
+        c->first_ts = c->min_ts = c->max_ts = ts;
+        c->first_bits = bits;
+        c->count = 1;
+        s.chunks.push_back(c);
+        s.prev_ts = ts;
+        s.prev_delta = 0;
+        s.prev_bits = bits;
+        s.lead = 0xFF;
+        retire_old(s);
+        return;
+    }
+
+    // Timestamp: delta-of-delta in the smallest bucket that holds it.
+    const int64_t delta = ts - s.prev_ts;
+    const int64_t dod = delta - s.prev_delta;
+    uint32_t pos = c->bits;
+    if (dod == 0) {
+        put(c->words, pos, 0, 1);
+    } else if (dod >= -64 && dod <= 63) {
+        put(c->words, pos, (uint64_t{0x2} << 7) | low_bits(static_cast<uint64_t>(dod), 7), 9);
+    } else if (dod >= -256 && dod <= 255) {
+        put(c->words, pos, (uint64_t{0x6} << 9) | low_bits(static_cast<uint64_t>(dod), 9), 12);
+    } else if (dod >= -2048 && dod <= 2047) {
+        put(c->words, pos, (uint64_t{0xE} << 12) | low_bits(static_cast<uint64_t>(dod), 12), 16);
+    } else if (dod >= INT32_MIN && dod <= INT32_MAX) {
+        put(c->words, pos, (uint64_t{0x1E} << 32) | low_bits(static_cast<uint64_t>(dod), 32), 37);
+    } else {
+        put(c->words, pos, 0x1F, 5);
+        put(c->words, pos, static_cast<uint64_t>(dod), 64);
+    }
+
+    // Value: XOR with the previous one.
+    const uint64_t x = bits ^ s.prev_bits;
+    if (x == 0) {
+        put(c->words, pos, 0, 1);
+    } else {
+        unsigned lead = clz64(x);
+        const unsigned trail = ctz64(x);
+        if (lead > 31) lead = 31;
+        if (s.lead != 0xFF && lead >= s.lead && trail >= s.trail) {
+            put(c->words, pos, 0x2, 2);
+            put(c->words, pos, x >> s.trail, 64 - s.lead - s.trail);
+        } else {
+            const unsigned len = 64 - lead - trail;
+            put(c->words, pos, (uint64_t{0x3} << 11) | (uint64_t{lead} << 6) | (len - 1), 13);
+            put(c->words, pos, x >> trail, len);
+            s.lead = static_cast<uint8_t>(lead);
+            s.trail = static_cast<uint8_t>(trail);
+        }
+    }
+
+    c->bits = pos;
+    ++c->count;
+    if (ts < c->min_ts) c->min_ts = ts;
+    if (ts > c->max_ts) c->max_ts = ts;
+    s.prev_ts = ts;
+    s.prev_delta = delta;
+    s.prev_bits = bits;
+}
+
+size_t SignalHistory::read(uint32_t signal, int64_t from_ns, int64_t to_ns, std::vector<HistoryPoint>& out) const {
+    if (signal >= series_.size() || from_ns > to_ns) return 0;
+    const int64_t unit = cfg_.ts_unit_ns;
+    const size_t before = out.size();
+    auto emit = [&](int64_t ts, uint64_t bits) {
+        const int64_t ns = ts * unit;
+        if (ns < from_ns || ns > to_ns) return;
+        HistoryPoint p;
+        p.ts_ns = ns;
+        std::memcpy(&p.value, &bits, sizeof(bits));
+        out.push_back(p);
+    };
+
+    const ChunkRing& chunks = series_[signal].chunks;
+    for (size_t k = 0; k < chunks.size(); ++k) {
+        const Chunk* c = chunks.at(k);
+        if (c->max_ts * unit < from_ns || c->min_ts * unit > to_ns) continue;
+
+        BitReader r(c->words);
+        int64_t ts = c->first_ts;
+        int64_t delta = 0;
+        uint64_t bits = c->first_bits;
+        unsigned lead = 0, trail = 0;
+        emit(ts, bits);
+        for (uint32_t i = 1; i < c->count; ++i) {
+            int64_t dod;
+            if (!r.bit()) dod = 0;
+            else if (!r.bit()) dod = sign_extend(r.get(7), 7);
+            else if (!r.bit()) dod = sign_extend(r.get(9), 9);
+            else if (!r.bit()) dod = sign_extend(r.get(12), 12);
+            else if (!r.bit()) dod = sign_extend(r.get(32), 32);
+            else dod = static_cast<int64_t>(r.get(64));
+            delta += dod;
+            ts += delta;
+
+            if (r.bit()) {
+                if (r.bit()) {
+                    lead = static_cast<unsigned>(r.get(5));
+                    const unsigned len = static_cast<unsigned>(r.get(6)) + 1;
+                    trail = 64 - lead - len;
+                }
+                bits ^= r.get(64 - lead - trail) << trail;
+            }
+            emit(ts, bits);
+        }
+    }
+    return out.size() - before;
+}
+
+HistoryStats SignalHistory::stats() const {
+    HistoryStats st;
+    for (const Series& s : series_) {
+        for (size_t k = 0; k < s.chunks.size(); ++k) {
+            const Chunk* c = s.chunks.at(k);
+            st.samples += c->count;
+            st.bits += c->bits + 128; // payload + raw first sample
+            ++st.chunks;
+        }
+    }
+    st.free_chunks = free_.size();
+    st.bytes = owned_.size() * sizeof(Chunk);
+    return st;
+}
+
+void SignalHistory::write_stats(std::ostream& os) const {
+    const HistoryStats st = stats();
+    const auto flags = os.flags();
+    os << "History: " << st.samples << " samples in " << st.chunks << " chunks (" << st.free_chunks << " free), "
+       << st.bytes / 1024 << " KiB, " << std::fixed << std::setprecision(2) << st.bits_per_sample() / 8.0
+       << " encoded / " << st.bytes_per_sample() << " allocated bytes per sample\n";
+    os.flags(flags);
+}
+
+} // namespace rbk
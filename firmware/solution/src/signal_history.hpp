@@ -0,0 +1,127 @@
+#pragma once
+#include "sample_sink.hpp"
+#include "signal_catalog.hpp"
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+namespace rbk {
+
+struct HistoryConfig {
+    int64_t retention_ns = 3600 * kNsPerSec;  // sealed chunks older than this are recycled
+    int64_t ts_unit_ns = 1000;                // stored timestamp resolution (candump: 1 us)
+};
+
+struct HistoryPoint {
+    int64_t ts_ns = 0;
+    double value = 0.0;
+};
+
+struct HistoryStats {
+    uint64_t samples = 0;       // currently held
+    uint64_t chunks = 0;        // in use (sealed + open)
+    uint64_t free_chunks = 0;   // recycled, ready for reuse
+    uint64_t bits = 0;          // encoded payload bits in use
+    uint64_t bytes = 0;         // chunk memory, in use + free
+
+    double bits_per_sample() const { return samples ? static_cast<double>(bits) / samples : 0.0; }
+    double bytes_per_sample() const { return samples ? static_cast<double>(bytes) / samples : 0.0; }
+};
+
+// Last `retention_ns` of every signal, compressed in RAM (Gorilla, Pelkonen
+// et al. 2015). Per signal, samples go into fixed-size chunks: the first
+// sample of a chunk is stored raw, later timestamps as delta-of-delta in
+// 1/9/12/16/37/69-bit codes and values as the XOR with the previous value
+// (1 bit when unchanged, otherwise only the meaningful bits, reusing the
+// previous leading/trailing-zero window when it fits). A chunk is sealed
+// when the next sample might not fit; sealed chunks are immutable.
+//
+// A periodic, slowly changing signal costs 2-12 bits per sample. Appending is
+// a few shifts and ORs into the open chunk; chunks come from a free list
+// refilled by retention, so steady state does not allocate.
+//
+// Retention is measured against the newest timestamp seen on any signal. A
+// series is trimmed whenever it seals a chunk, and all series are swept every
+// kSweepAppends appends, so a signal that stops updating is dropped once it
+// falls out of the window like any other.
+//
+// Timestamps are kept in units of ts_unit_ns (finer parts are dropped).
+// Not thread-safe: append and read from the same thread, or serialise.
+class SignalHistory : public SampleSink {
+public:
+    static constexpr size_t kChunkWords = 64;                 // 512-byte payload
+    static constexpr size_t kChunkBits = kChunkWords * 64;
+    static constexpr uint32_t kSweepAppends = 1024;           // appends between retention sweeps
+
+    explicit SignalHistory(const SignalCatalog& cat, HistoryConfig cfg = {});
+    ~SignalHistory() override;
+
+    SignalHistory(const SignalHistory&) = delete;
+    SignalHistory& operator=(const SignalHistory&) = delete;
+
+    void on_sample(const Sample& s) override { append(s.signal, s.ts_ns, s.value); }
+    void append(uint32_t signal, int64_t ts_ns, double value);
+
+    // Appends samples of `signal` with from_ns <= ts <= to_ns to `out`, in
+    // insertion order; returns how many.
+    size_t read(uint32_t signal, int64_t from_ns, int64_t to_ns, std::vector<HistoryPoint>& out) const;
+
+    size_t size() const { return series_.size(); }
+    HistoryStats stats() const;
+    void write_stats(std::ostream& os) const;
+
+private:
+    struct Chunk {
+        int64_t first_ts = 0;       // in units
+        uint64_t first_bits = 0;    // first value, raw
+        int64_t min_ts = 0;         // in units, for range skips and retention
+        int64_t max_ts = 0;
+        uint32_t count = 0;
+        uint32_t bits = 0;          // used payload bits
+        uint64_t words[kChunkWords];
+    };
+
+    // Chunks of one series, oldest first, in a power-of-two ring that only
+    // grows (while the window fills), so steady-state churn never allocates.
+    struct ChunkRing {
+        std::vector<Chunk*> slots;
+        size_t head = 0;
+        size_t count = 0;
+
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        Chunk* at(size_t i) const { return slots[(head + i) & (slots.size() - 1)]; }
+        Chunk* front() const { return at(0); }
+        Chunk* back() const { return at(count - 1); }
+        void pop_front() {
+            head = (head + 1) & (slots.size() - 1);
+            --count;
+        }
+        void push_back(Chunk* c);
+    };
+
+    struct Series {
+        ChunkRing chunks;           // back() is the open one
+        int64_t prev_ts = 0;
+        int64_t prev_delta = 0;
+        uint64_t prev_bits = 0;
+        uint8_t lead = 0xFF;        // previous XOR window; 0xFF = none yet
+        uint8_t trail = 0;
+    };
+
+    Chunk* new_chunk();
+    void retire_old(Series& s);  // on sealing one of its chunks
+    void retire_old();           // every series, every kSweepAppends appends
+
+    const SignalCatalog& cat_;
+    HistoryConfig cfg_;
+    int64_t retention_units_ = 0;
+    int64_t newest_ = INT64_MIN;    // high-water timestamp over all signals, in units
+    uint32_t since_sweep_ = 0;
+    std::vector<Series> series_;
+    std::vector<std::unique_ptr<Chunk>> owned_;
+    std::vector<Chunk*> free_;
+};
+
+} // namespace rbk
@@ -0,0 +1,139 @@
+#include "timestamp.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace rbk {
+
+// Largest seconds value for which sec * kNsPerSec + frac still fits in int64.
+static constexpr long kMaxSecondsDigits = 10;
+static constexpr int64_t kMaxSeconds = (INT64_MAX - (kNsPerSec - 1)) / kNsPerSec;
+
+bool parse_timestamp(const char* begin, const char* end, int64_t& ts_ns) {
+    const char* p = begin;
+    int64_t sec = 0;
+    const char* sec_start = p;
+    while (p < end && *p >= '0' && *p <= '9') {
+        if (p - sec_start == kMaxSecondsDigits) return false; // would overflow below
+        sec = sec * 10 + (*p - '0');
+        ++p;
+    }
+    if (p == sec_start || p == end || *p != '.' || sec > kMaxSeconds) return false;
+    ++p;
+
+    const char* frac_start = p;
+    int64_t frac = 0;
+    int digits = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        if (digits < 9) {
+            frac = frac * 10 + (*p - '0');
+            ++digits;
+        }
+        ++p;
+    }
+    if (p == frac_start || p != end) return false;
+
+    static const int64_t kScale[10] = {
+        1000000000, 100000000, 10000000, 1000000, 100000, 10000, 1000, 100, 10, 1};
+    ts_ns = sec * kNsPerSec + frac * kScale[digits];
+    return true;
+}
+
+static const int64_t kPow10[] = {
+    1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL,
+    100000000LL, 1000000000LL, 10000000000LL, 100000000000LL, 1000000000000LL,
+    10000000000000LL, 100000000000000LL, 1000000000000000LL};
+
+// Reference path: rebuild the double the old pipeline held (strtod of the
+// decimal text) and print it with %.15g.
+static size_t format_via_double(int64_t ts_ns, char* out) {
+    char dec[40];
+    const bool neg = ts_ns < 0;
+    const uint64_t mag = neg ? 0 - static_cast<uint64_t>(ts_ns) : static_cast<uint64_t>(ts_ns);
+    std::snprintf(dec, sizeof(dec), "%s%llu.%09llu", neg ? "-" : "",
+                  static_cast<unsigned long long>(mag / kNsPerSec),
+                  static_cast<unsigned long long>(mag % kNsPerSec));
+    const int n = std::snprintf(out, kTimestampBufLen, "%.15g", std::strtod(dec, nullptr));
+    return n > 0 ? static_cast<size_t>(n) : 0;
+}
+
+// Write v in decimal; returns the number of characters.
+static size_t write_u64(uint64_t v, char* out) {
+    char tmp[20];
+    size_t n = 0;
+    do {
+        tmp[n++] = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v);
+    for (size_t i = 0; i < n; ++i) out[i] = tmp[n - 1 - i];
+    return n;
+}
+
+// Write ".<frac>" as exactly `width` digits minus trailing zeros; nothing if frac == 0.
+static size_t write_fraction(int64_t frac, int width, char* out) {
+    if (frac == 0) return 0;
+    while (frac % 10 == 0) {
+        frac /= 10;
+        --width;
+    }
+    out[0] = '.';
+    for (int i = width; i > 0; --i) {
+        out[i] = static_cast<char>('0' + frac % 10);
+        frac /= 10;
+    }
+    return static_cast<size_t>(width) + 1;
+}
+
+size_t format_timestamp(int64_t ts_ns, char* out) {
+    if (ts_ns < 0) return format_via_double(ts_ns, out);
+
+    int64_t sec = ts_ns / kNsPerSec;
+    int64_t frac = ts_ns % kNsPerSec;
+
+    if (sec == 0) {
+        if (frac == 0) {
+            out[0] = '0';
+            return 1;
+        }
+        // %g switches to exponent notation below 1e-4
+        if (frac < 100000) return format_via_double(ts_ns, out);
+        out[0] = '0';
+        return 1 + write_fraction(frac, 9, out + 1);
+    }
+
+    int digits = 1;
+    while (digits < 16 && sec >= kPow10[digits]) ++digits;
+    if (digits > 10) return format_via_double(ts_ns, out); // beyond year 2286
+
+    const int keep = 15 - digits; // fraction digits %.15g keeps
+    if (keep < 9) {
+        // Round to `keep` digits. The double the old code printed was the
+        // correctly rounded decimal, i.e. within half an ulp of the exact
+        // value (~120 ns at today's epoch); only a remainder that close to the
+        // half-way point can round the other way there, so only those take
+        // the reference path (for microsecond stamps: exactly .xxxxx5).
+        const int64_t unit = kPow10[9 - keep];
+        const int64_t rem = frac % unit;
+        const int64_t half = unit / 2;
+        const int64_t dist = rem > half ? rem - half : half - rem;
+        const int top_bit = 63 - __builtin_clzll(static_cast<uint64_t>(sec));
+        const int64_t half_ulp_ns = (kNsPerSec >> (53 - top_bit)) + 2; // rounded up, plus slack
+        if (dist <= half_ulp_ns) return format_via_double(ts_ns, out);
+
+        frac /= unit;
+        if (rem > half && ++frac == kPow10[keep]) {
+            // carry into the seconds; the digit count may change, so let the
+            // reference path handle this once-in-a-blue-moon case
+            return format_via_double(ts_ns, out);
+        }
+        const size_t n = write_u64(static_cast<uint64_t>(sec), out);
+        return n + write_fraction(frac, keep, out + n);
+    }
+
+    // Up to 15 significant digits in total: %.15g reproduces the decimal exactly.
+    const size_t n = write_u64(static_cast<uint64_t>(sec), out);
+    return n + write_fraction(frac, 9, out + n);
+}
+
+} // namespace rbk
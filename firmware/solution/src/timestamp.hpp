@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace rbk {
+
+// Timestamps are carried as int64_t nanoseconds since the UNIX epoch from
+// parse to output, so kernel nanosecond timestamps survive unchanged.
+
+constexpr int64_t kNsPerSec = 1000000000LL;
+
+// Parse "<seconds>.<fraction>" (digits only, as in a candump "(...)" field)
+// with integer arithmetic. Fraction digits past nanoseconds are truncated.
+// Returns false if either part is empty or contains a non-digit.
+bool parse_timestamp(const char* begin, const char* end, int64_t& ts_ns);
+
+// Longest text format_timestamp() can produce.
+constexpr size_t kTimestampBufLen = 32;
+
+// Format exactly as `os << std::setprecision(15) << seconds_as_double` did,
+// i.e. %.15g of the seconds value, using integer formatting on the hot path.
+// Returns the number of characters written (not NUL-terminated).
+size_t format_timestamp(int64_t ts_ns, char* out);
+
+} // namespace rbk
@@ -0,0 +1,243 @@
+#include "trigger.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace rbk {
+
+// Frames to hold pre_ns of history at peak_fps, unless fixed by ring_frames.
+static size_t ring_frames_for(const TriggerConfig& cfg) {
+    if (cfg.ring_frames) return cfg.ring_frames;
+    return static_cast<size_t>(std::ceil(static_cast<double>(cfg.pre_ns) / kNsPerSec * cfg.peak_fps));
+}
+
+bool parse_trigger(const std::string& s, TriggerSpec& out) {
+    const size_t op_pos = s.find_first_of("<>=!");
+    if (op_pos == std::string::npos) return false;
+
+    size_t end = op_pos;
+    while (end > 0 && std::isspace(static_cast<unsigned char>(s[end - 1]))) --end;
+    size_t begin = 0;
+    while (begin < end && std::isspace(static_cast<unsigned char>(s[begin]))) ++begin;
+    if (begin == end) return false;
+
+    TriggerOp op;
+    size_t val_pos = op_pos + 2;
+    const std::string two = s.substr(op_pos, 2);
+    if (two == ">=") op = TriggerOp::Ge;
+    else if (two == "<=") op = TriggerOp::Le;
+    else if (two == "==") op = TriggerOp::Eq;
+    else if (two == "!=") op = TriggerOp::Ne;
+    else if (s[op_pos] == '>') op = TriggerOp::Gt, val_pos = op_pos + 1;
+    else if (s[op_pos] == '<') op = TriggerOp::Lt, val_pos = op_pos + 1;
+    else return false;
+
+    const char* v = s.c_str() + val_pos;
+    char* vend = nullptr;
+    const double value = std::strtod(v, &vend);
+    if (vend == v) return false;
+    while (std::isspace(static_cast<unsigned char>(*vend))) ++vend;
+    if (*vend) return false;
+
+    out.signal = s.substr(begin, end - begin);
+    out.op = op;
+    out.value = value;
+    out.text = s;
+    return true;
+}
+
+const char* to_string(TriggerOp op) {
+    switch (op) {
+    case TriggerOp::Gt: return ">";
+    case TriggerOp::Ge: return ">=";
+    case TriggerOp::Lt: return "<";
+    case TriggerOp::Le: return "<=";
+    case TriggerOp::Eq: return "==";
+    case TriggerOp::Ne: return "!=";
+    }
+    return "?";
+}
+
+FrameRing::FrameRing(size_t capacity)
+    : frames_(new RawFrame[std::max<size_t>(capacity, 1)]), capacity_(std::max<size_t>(capacity, 1)) {}
+
+void FrameRing::push(const ParsedLine& pl) {
+    size_t k;
+    if (size_ < capacity_) {
+        k = head_ + size_;
+        if (k >= capacity_) k -= capacity_;
+        ++size_;
+    } else {
+        k = head_;
+        if (++head_ == capacity_) head_ = 0;
+    }
+    RawFrame& f = frames_[k];
+    f.ts_ns = pl.ts_ns;
+    f.can_id = pl.can_id;
+    f.bus = pl.bus;
+    f.len = static_cast<uint8_t>(std::min<size_t>(pl.data.size(), sizeof(f.data)));
+    std::memcpy(f.data, pl.data.data(), f.len);
+}
+
+size_t format_candump(const RawFrame& f, const char* iface, char* out) {
+    const long long sec = static_cast<long long>(f.ts_ns / kNsPerSec);
+    const long long frac = static_cast<long long>(f.ts_ns % kNsPerSec);
+    // Microseconds like candump unless the source had finer timestamps.
+    const int n = (frac % 1000 == 0)
+        ? std::snprintf(out, kCandumpLineLen, "(%lld.%06lld) %.15s %X#", sec, frac / 1000, iface, f.can_id)
+        : std::snprintf(out, kCandumpLineLen, "(%lld.%09lld) %.15s %X#", sec, frac, iface, f.can_id);
+    size_t len = static_cast<size_t>(n);
+    static const char hex[] = "0123456789ABCDEF";
+    for (uint8_t i = 0; i < f.len; ++i) {
+        out[len++] = hex[f.data[i] >> 4];
+        out[len++] = hex[f.data[i] & 0xF];
+    }
+    out[len++] = '\n';
+    return len;
+}
+
+TriggerEngine::TriggerEngine(const SignalCatalog& cat, const BusMap& buses, TriggerConfig cfg)
+    : cat_(cat), buses_(buses), cfg_(std::move(cfg)),
+      ring_(ring_frames_for(cfg_)),
+      first_(cat.size(), -1) {}
+
+bool TriggerEngine::add(const TriggerSpec& spec, std::string* err) {
+    const uint32_t id = static_cast<uint32_t>(specs_.size());
+    auto matches = [&](uint32_t i, bool by_message) {
+        const SignalInfo& si = cat_.info(i);
+        if (!by_message) return si.name == spec.signal;
+        const CatalogMessage* m = cat_.find(si.bus, si.can_id);
+        return m && m->msg->Name() == spec.signal;
+    };
+    // A signal name first; otherwise a message name means each of its signals.
+    bool by_message = true;
+    for (uint32_t i = 0; i < cat_.size() && by_message; ++i) by_message = !matches(i, false);
+
+    // One edge per signal, or per message when matching by message name.
+    std::vector<int64_t> message_edge(by_message ? cat_.message_count() : 0, -1);
+    bool found = false;
+    for (uint32_t i = 0; i < cat_.size(); ++i) {
+        if (!matches(i, by_message)) continue;
+        Condition c;
+        c.spec = id;
+        c.op = spec.op;
+        c.value = spec.value;
+        int64_t* shared = by_message ? &message_edge[cat_.find(cat_.info(i).bus, cat_.info(i).can_id)->index]
+                                     : nullptr;
+        if (shared && *shared >= 0) {
+            c.edge = static_cast<uint32_t>(*shared);
+        } else {
+            c.edge = static_cast<uint32_t>(edges_.size());
+            edges_.emplace_back();
+            if (shared) *shared = c.edge;
+        }
+        c.next = first_[i];
+        first_[i] = static_cast<int32_t>(conds_.size());
+        conds_.push_back(c);
+        found = true;
+    }
+    if (!found) {
+        if (err) *err = "no signal or message called " + spec.signal;
+        return false;
+    }
+    specs_.push_back(spec);
+    return true;
+}
+
+void TriggerEngine::record(const ParsedLine& pl) {
+    ring_.push(pl);
+    if (!capturing_) return;
+    if (pl.ts_ns > capture_end_ns_) {
+        close_capture();
+        return;
+    }
+    write_frame(ring_.at(ring_.size() - 1));
+}
+
+void TriggerEngine::begin_frame(const ParsedLine& /*pl*/, uint8_t /*bus*/) {
+    ++frame_;
+}
+
+void TriggerEngine::on_sample(const Sample& s) {
+    for (int32_t k = first_[s.signal]; k >= 0;) {
+        const Condition& c = conds_[static_cast<size_t>(k)];
+        Edge& e = edges_[c.edge];
+        if (e.frame != frame_) {
+            // First sample of this edge in the frame: roll the state over.
+            e.frame = frame_;
+            e.prev = e.active;
+            e.active = false;
+        }
+        if (!e.active && test(c.op, s.value, c.value)) {
+            e.active = true;
+            if (!e.prev) fire(c, s);
+        }
+        k = c.next;
+    }
+}
+
+void TriggerEngine::fire(const Condition& c, const Sample& s) {
+    ++fired_;
+    const TriggerSpec& spec = specs_[c.spec];
+    const SignalInfo& si = cat_.info(s.signal);
+    char ts[kTimestampBufLen];
+    const size_t ts_len = format_timestamp(s.ts_ns, ts);
+
+    if (capturing_) {
+        capture_ << "# trigger " << spec.text << " (" << si.name << " = " << s.value << ") at "
+                 << std::string(ts, ts_len) << "\n";
+        capture_end_ns_ = std::max(capture_end_ns_, s.ts_ns + cfg_.post_ns);
+        return;
+    }
+    if (files_.size() >= cfg_.max_captures) {
+        ++suppressed_;
+        return;
+    }
+
+    char name[16];
+    std::snprintf(name, sizeof(name), "_%03zu.log", files_.size() + 1);
+    const std::string path = cfg_.prefix + name;
+    capture_.open(path, std::ios::binary | std::ios::trunc);
+    if (!capture_) {
+        ++suppressed_;
+        return;
+    }
+    files_.push_back(path);
+    capturing_ = true;
+    capture_end_ns_ = s.ts_ns + cfg_.post_ns;
+    capture_.precision(15);
+    capture_ << "# trigger " << spec.text << " (" << si.name << " = " << s.value << ") at "
+             << std::string(ts, ts_len) << " on " << buses_.bus(si.bus).name << "\n"
+             << "# window -" << cfg_.pre_ns / 1e9 << " s / +" << cfg_.post_ns / 1e9 << " s\n";
+
+    // Pre-trigger history; the ring is in arrival order.
+    const int64_t from = s.ts_ns - cfg_.pre_ns;
+    if (ring_.size() == ring_.capacity() && ring_.at(0).ts_ns > from) {
+        const size_t n = format_timestamp(ring_.at(0).ts_ns, ts);
+        capture_ << "# history starts at " << std::string(ts, n) << " (ring full, raise --trigger-rate)\n";
+    }
+    for (size_t i = 0; i < ring_.size(); ++i) {
+        const RawFrame& f = ring_.at(i);
+        if (f.ts_ns >= from) write_frame(f);
+    }
+}
+
+void TriggerEngine::write_frame(const RawFrame& f) {
+    const char* iface = f.bus < buses_.size() ? buses_.bus(f.bus).name.c_str() : "?";
+    capture_.write(line_, static_cast<std::streamsize>(format_candump(f, iface, line_)));
+}
+
+void TriggerEngine::close_capture() {
+    capture_.close();
+    capture_.clear();
+    capturing_ = false;
+}
+
+void TriggerEngine::finish() {
+    if (capturing_) close_capture();
+}
+
+} // namespace rbk
@@ -0,0 +1,167 @@
+#pragma once
+#include "bus_map.hpp"
+#include "sample_sink.hpp"
+#include "signal_catalog.hpp"
+#include "timestamp.hpp"
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace rbk {
+
+enum class TriggerOp : uint8_t { Gt, Ge, Lt, Le, Eq, Ne };
+
+// "<name><op><value>" with op one of > >= < <= == != and optional spaces,
+// e.g. "M171_Fault_Codes != 0", "Relay_State==0", "Brake_Pressure>15".
+// A message name stands for its signals: the condition holds for a frame
+// when it holds for any of them.
+struct TriggerSpec {
+    std::string signal;
+    TriggerOp op = TriggerOp::Gt;
+    double value = 0.0;
+    std::string text;   // as given, for capture headers
+};
+
+bool parse_trigger(const std::string& s, TriggerSpec& out);
+const char* to_string(TriggerOp op);
+
+struct TriggerConfig {
+    int64_t pre_ns = 5 * kNsPerSec;    // history written before the trigger
+    int64_t post_ns = 5 * kNsPerSec;   // frames written after it
+    double peak_fps = 20000;           // frames/s over all buses the ring must cover pre_ns at
+    size_t ring_frames = 0;            // raw frames kept in memory; 0 = pre_ns x peak_fps
+    std::string prefix = "capture";    // files are <prefix>_NNN.log
+    unsigned max_captures = 100;       // later triggers are only counted
+};
+
+// One raw frame as seen on the bus, CAN FD payloads included.
+struct RawFrame {
+    int64_t ts_ns = 0;
+    uint32_t can_id = 0;
+    uint8_t bus = 0;
+    uint8_t len = 0;
+    uint8_t data[64];
+};
+
+// Fixed-capacity history of the most recent frames. All memory is taken in
+// the constructor; push() overwrites the oldest frame once full.
+class FrameRing {
+public:
+    explicit FrameRing(size_t capacity);
+
+    void push(const ParsedLine& pl);
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    // i = 0 is the oldest frame still held.
+    const RawFrame& at(size_t i) const {
+        size_t k = head_ + i;
+        if (k >= capacity_) k -= capacity_;
+        return frames_[k];
+    }
+
+private:
+    std::unique_ptr<RawFrame[]> frames_;
+    size_t capacity_ = 0;
+    size_t head_ = 0;   // oldest
+    size_t size_ = 0;
+};
+
+// candump line "(sec.frac) iface ID#DATA\n" (what parse_line reads); returns
+// its length. `out` needs kCandumpLineLen bytes.
+constexpr size_t kCandumpLineLen = 64 + 2 * 64;
+size_t format_candump(const RawFrame& f, const char* iface, char* out);
+
+// Watches decoded samples for trigger conditions and, on a hit, writes the
+// last pre_ns of raw frames plus the next post_ns to a capture file that
+// `answer --input` can replay.
+//
+// Conditions are edge-triggered per frame: one fires when it becomes true
+// and re-arms once it has been false again, so a fault code that stays set
+// produces one capture, not one per frame. A message-name condition has one
+// edge for the whole message (true if any of its signals matches), so a
+// frame with several non-zero fault words fires it once. A trigger while a
+// capture is open is noted in it and extends its post-trigger window.
+//
+// The ring is sized once, in frames: ring_frames if set, otherwise pre_ns
+// times peak_fps. Traffic above that rate truncates the history (noted in
+// the capture).
+//
+// Per sample the cost is one table load for signals without a condition and
+// a compare per condition otherwise; record() is a copy into the ring.
+// Nothing is allocated per frame, only when a capture file is opened.
+class TriggerEngine : public SampleSink {
+public:
+    TriggerEngine(const SignalCatalog& cat, const BusMap& buses, TriggerConfig cfg);
+
+    // Applies to every signal called spec.signal on any bus, or failing that
+    // to every signal of the message(s) of that name; false if neither exists.
+    bool add(const TriggerSpec& spec, std::string* err = nullptr);
+    size_t triggers() const { return specs_.size(); }
+
+    // Every frame on a mapped bus, before it is decoded.
+    void record(const ParsedLine& pl);
+    void begin_frame(const ParsedLine& pl, uint8_t bus) override;
+    void on_sample(const Sample& s) override;
+    // Close the open capture (end of input).
+    void finish();
+
+    uint64_t fired() const { return fired_; }
+    uint64_t suppressed() const { return suppressed_; }
+    size_t ring_capacity() const { return ring_.capacity(); }
+    const std::vector<std::string>& files() const { return files_; }
+
+private:
+    struct Condition {
+        uint32_t spec = 0;
+        TriggerOp op = TriggerOp::Gt;
+        uint32_t edge = 0;      // into edges_; shared by the signals of a message trigger
+        double value = 0.0;
+        int32_t next = -1;      // next condition on the same signal
+    };
+
+    // Edge state of one (trigger, signal) or (trigger, message) pair.
+    struct Edge {
+        uint64_t frame = 0;     // frame_ when `active` was last reset
+        bool prev = false;      // held on the previous frame it was tested in
+        bool active = false;    // held on some sample of frame `frame`
+    };
+
+    static bool test(TriggerOp op, double v, double ref) {
+        switch (op) {
+        case TriggerOp::Gt: return v > ref;
+        case TriggerOp::Ge: return v >= ref;
+        case TriggerOp::Lt: return v < ref;
+        case TriggerOp::Le: return v <= ref;
+        case TriggerOp::Eq: return v == ref;
+        case TriggerOp::Ne: return v != ref;
+        }
+        return false;
+    }
+
+    void fire(const Condition& c, const Sample& s);
+    void write_frame(const RawFrame& f);
+    void close_capture();
+
+    const SignalCatalog& cat_;
+    const BusMap& buses_;
+    TriggerConfig cfg_;
+    FrameRing ring_;
+    std::vector<TriggerSpec> specs_;
+    std::vector<Condition> conds_;
+    std::vector<Edge> edges_;
+    std::vector<int32_t> first_;     // per catalog signal: first condition, -1 = none
+    uint64_t frame_ = 0;
+
+    std::ofstream capture_;
+    bool capturing_ = false;
+    int64_t capture_end_ns_ = 0;
+    std::vector<std::string> files_;
+    uint64_t fired_ = 0;
+    uint64_t suppressed_ = 0;
+    char line_[kCandumpLineLen];
+};
+
+} // namespace rbk
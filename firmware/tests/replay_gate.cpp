@@ -0,0 +1,336 @@
+// Replay throughput gate.
+//
+// Generates a deterministic synthetic candump log covering every message in the
+// three real DBCs, decodes it with each available backend, checks that all
+// backends produce identical output and compares their speed against the
+// committed baseline. "rbk" is the pipeline answer runs (SignalCatalog +
+// FrameMemo + TextSink), "rbk-nomemo" the same with --no-memo, and "stage4"
+// the hand-written parser as an independent reference.
+//
+// Speed is gated as frames/s relative to stage4 measured in the same run, so
+// the baseline carries over between machines: absolute frames/s are only
+// printed. Exit code is non-zero on an output mismatch or when a backend's
+// ratio falls below baseline * (1 - tolerance).
+
+#include "solution/src/can_decode.hpp"
+#include "solution/src/dbc_simple.hpp"
+#include "solution/src/frame_memo.hpp"
+#include "solution/src/sample_sink.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* kDbcFiles[3] = {"ControlBus.dbc", "SensorBus.dbc", "TractiveBus.dbc"};
+
+// FNV-1a over everything written to the stream; lets us compare multi-GB
+// outputs without keeping them in memory.
+class HashBuf : public std::streambuf {
+public:
+    uint64_t hash() const { return h_; }
+    uint64_t bytes() const { return n_; }
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (ch != traits_type::eof()) mix(static_cast<unsigned char>(ch), 1);
+        return ch;
+    }
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        for (std::streamsize i = 0; i < n; ++i) mix(static_cast<unsigned char>(s[i]), 0);
+        n_ += static_cast<uint64_t>(n);
+        return n;
+    }
+
+private:
+    void mix(unsigned char c, uint64_t count) {
+        h_ ^= c;
+        h_ *= 0x100000001b3ULL;
+        n_ += count;
+    }
+    uint64_t h_ = 0xcbf29ce484222325ULL;
+    uint64_t n_ = 0;
+};
+
+// xorshift64*: small, fast and identical on every platform.
+struct Rng {
+    uint64_t s;
+    uint64_t next() {
+        s ^= s >> 12;
+        s ^= s << 25;
+        s ^= s >> 27;
+        return s * 0x2545F4914F6CDD1DULL;
+    }
+};
+
+struct GenMsg {
+    int bus;
+    uint32_t id;
+    uint8_t dlc;
+};
+
+// Build the synthetic log. Every message is emitted once up front so coverage
+// does not depend on the frame count, then messages are drawn uniformly.
+// IDs are written exactly as the DBC stores them (extended IDs keep bit 31)
+// so both backends resolve them.
+std::string generate_log(const stage4::Network (&nets)[3], size_t frames, uint64_t seed) {
+    std::vector<GenMsg> msgs;
+    for (int bus = 0; bus < 3; ++bus) {
+        for (const auto& kv : nets[bus].msgs) {
+            if (kv.second.dlc == 0) continue; // VECTOR__INDEPENDENT_SIG_MSG pseudo message
+            msgs.push_back({bus, kv.first, kv.second.dlc});
+        }
+    }
+    // unordered_map order is not portable; sort for a stable log
+    std::sort(msgs.begin(), msgs.end(), [](const GenMsg& a, const GenMsg& b) {
+        return a.bus != b.bus ? a.bus < b.bus : a.id < b.id;
+    });
+
+    Rng rng{seed};
+    std::string log;
+    log.reserve(frames * 48);
+
+    uint64_t ts_us = 1705638799000000ULL;
+    char buf[96];
+    for (size_t i = 0; i < frames; ++i) {
+        const GenMsg& m = (i < msgs.size()) ? msgs[i] : msgs[rng.next() % msgs.size()];
+        ts_us += 1 + rng.next() % 400;
+
+        int n = std::snprintf(buf, sizeof(buf), "(%llu.%06llu) vcan%d %X#",
+                              static_cast<unsigned long long>(ts_us / 1000000),
+                              static_cast<unsigned long long>(ts_us % 1000000),
+                              m.bus, m.id);
+        log.append(buf, static_cast<size_t>(n));
+
+        uint64_t payload = rng.next();
+        for (uint8_t b = 0; b < m.dlc; ++b) {
+            static const char hex[] = "0123456789ABCDEF";
+            const uint8_t byte = static_cast<uint8_t>(payload >> (8 * (b % 8)));
+            log.push_back(hex[byte >> 4]);
+            log.push_back(hex[byte & 0xF]);
+        }
+        log.push_back('\n');
+    }
+    return log;
+}
+
+struct Result {
+    std::string backend;
+    uint64_t hash = 0;
+    uint64_t bytes = 0;
+    double fps = 0.0;
+};
+
+// `make(os)` returns the per-frame decode function for one run, so every run
+// starts with fresh sink and memo state.
+template <typename MakeFn>
+Result run_backend(const std::string& name, const std::string& log, size_t frames,
+                   int repeat, MakeFn make) {
+    Result r;
+    r.backend = name;
+    for (int rep = 0; rep < repeat; ++rep) {
+        HashBuf hb;
+        std::ostream os(&hb);
+        os.setf(std::ios::fmtflags(0), std::ios::floatfield);
+        os << std::setprecision(15);
+        auto decode = make(os);
+
+        std::string line;
+        rbk::ParsedLine pl;
+        const auto t0 = std::chrono::steady_clock::now();
+        size_t pos = 0;
+        while (pos < log.size()) {
+            size_t eol = log.find('\n', pos);
+            if (eol == std::string::npos) eol = log.size();
+            line.assign(log, pos, eol - pos);
+            pos = eol + 1;
+            if (!rbk::parse_line(line, pl, rbk::BusMap::builtin()) || pl.bus >= 3) continue;
+            decode(pl);
+        }
+        const auto t1 = std::chrono::steady_clock::now();
+        const double secs = std::chrono::duration<double>(t1 - t0).count();
+        const double fps = secs > 0.0 ? static_cast<double>(frames) / secs : 0.0;
+
+        r.hash = hb.hash();
+        r.bytes = hb.bytes();
+        if (fps > r.fps) r.fps = fps;
+    }
+    return r;
+}
+
+// Baseline file: "<backend>/stage4 <ratio>", "frames <n>" and "hash <hex>"
+// lines, '#' comments. The golden hash only applies to a run of the same length.
+std::map<std::string, std::string> read_baseline(const std::string& path) {
+    std::map<std::string, std::string> kv;
+    std::ifstream is(path);
+    std::string line;
+    while (std::getline(is, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream ls(line);
+        std::string k, v;
+        if (ls >> k >> v) kv[k] = v;
+    }
+    return kv;
+}
+
+void usage() {
+    std::cerr << "usage: replay_gate --dbc-dir DIR [--baseline FILE] [--frames N]\n"
+                 "                   [--tolerance F] [--repeat N] [--write-baseline]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string dbc_dir = "dbc-files";
+    std::string baseline_path;
+    size_t frames = 2000000;
+    double tolerance = 0.30;
+    int repeat = 1;
+    bool write_baseline = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        auto need = [&](const char* what) -> std::string {
+            if (i + 1 >= argc) { usage(); std::cerr << "missing value for " << what << "\n"; std::exit(2); }
+            return argv[++i];
+        };
+        if (a == "--dbc-dir") dbc_dir = need("--dbc-dir");
+        else if (a == "--baseline") baseline_path = need("--baseline");
+        else if (a == "--frames") frames = std::stoull(need("--frames"));
+        else if (a == "--tolerance") tolerance = std::stod(need("--tolerance"));
+        else if (a == "--repeat") repeat = std::max(1, std::stoi(need("--repeat")));
+        else if (a == "--write-baseline") write_baseline = true;
+        else { usage(); return 2; }
+    }
+
+    // ---- Load both backends ----
+    stage4::Network s4[3];
+    std::unique_ptr<dbcppp::INetwork> nets[3];
+    rbk::SignalCatalog catalog;
+    for (int bus = 0; bus < 3; ++bus) {
+        const std::string path = dbc_dir + "/" + kDbcFiles[bus];
+        std::string err;
+        if (!stage4::parse_dbc_file(path, s4[bus], &err)) {
+            std::cerr << "stage4 failed to load " << path << ": " << err << "\n";
+            return 1;
+        }
+        nets[bus] = rbk::load_network(path);
+        if (!nets[bus]) {
+            std::cerr << "dbcppp failed to load " << path << "\n";
+            return 1;
+        }
+        catalog.add_bus(*nets[bus]);
+    }
+
+    const std::string log = generate_log(s4, frames, 0x5EEDC0FFEEULL);
+    std::cout << "replay_gate: " << frames << " frames, " << log.size() / (1024 * 1024)
+              << " MiB of candump text\n";
+
+    std::vector<Result> results;
+    results.push_back(run_backend("rbk", log, frames, repeat, [&](std::ostream& os) {
+        auto text = std::make_shared<rbk::TextSink>(catalog, os);
+        auto memo = std::make_shared<rbk::FrameMemo>(catalog);
+        return [&catalog, text, memo](const rbk::ParsedLine& pl) {
+            rbk::decode_frame(pl, pl.bus, catalog, *text, *memo);
+        };
+    }));
+    results.push_back(run_backend("rbk-nomemo", log, frames, repeat, [&](std::ostream& os) {
+        auto text = std::make_shared<rbk::TextSink>(catalog, os);
+        return [&catalog, text](const rbk::ParsedLine& pl) { rbk::decode_frame(pl, pl.bus, catalog, *text); };
+    }));
+    results.push_back(run_backend("stage4", log, frames, repeat, [&](std::ostream& os) {
+        return [&s4, &os](const rbk::ParsedLine& pl) {
+            stage4::decode_frame_and_write(s4[pl.bus], pl.can_id, pl.ts_ns, pl.data, os);
+        };
+    }));
+
+    int rc = 0;
+    auto hex = [](uint64_t v) {
+        std::ostringstream ss;
+        ss << std::hex << std::setw(16) << std::setfill('0') << v;
+        return ss.str();
+    };
+
+    // ---- Output equivalence ----
+    for (const auto& r : results) {
+        std::cout << "  " << std::left << std::setw(10) << r.backend
+                  << " hash=" << hex(r.hash) << " bytes=" << r.bytes
+                  << " frames/s=" << std::fixed << std::setprecision(0) << r.fps << "\n";
+        if (r.hash != results.front().hash || r.bytes != results.front().bytes) {
+            std::cerr << "FAIL: " << r.backend << " output differs from " << results.front().backend << "\n";
+            rc = 1;
+        }
+    }
+
+    if (baseline_path.empty()) return rc;
+
+    // Throughput relative to the reference parser in this same run.
+    const std::string kReference = "stage4";
+    double ref_fps = 0.0;
+    for (const auto& r : results) {
+        if (r.backend == kReference) ref_fps = r.fps;
+    }
+    auto ratio_key = [&](const Result& r) { return r.backend + "/" + kReference; };
+
+    if (write_baseline) {
+        std::ofstream os(baseline_path);
+        os << "# replay_gate baseline: frames/s per backend relative to " << kReference
+           << " in the same run (best of " << repeat << "), " << frames << " frames\n";
+        os << "# regenerate with: replay_gate --dbc-dir dbc-files --baseline <this file> --repeat 3 --write-baseline\n";
+        os << "frames " << frames << "\n";
+        os << "hash " << hex(results.front().hash) << "\n";
+        for (const auto& r : results) {
+            if (r.backend == kReference) continue;
+            os << ratio_key(r) << ' ' << std::fixed << std::setprecision(3) << r.fps / ref_fps << "\n";
+        }
+        std::cout << "wrote baseline " << baseline_path << "\n";
+        return rc;
+    }
+
+    // ---- Golden output + throughput against baseline ----
+    const auto base = read_baseline(baseline_path);
+    if (base.empty()) {
+        std::cerr << "FAIL: could not read baseline " << baseline_path << "\n";
+        return 1;
+    }
+    auto golden = base.find("hash");
+    auto golden_frames = base.find("frames");
+    const bool same_run = golden_frames != base.end() && std::stoull(golden_frames->second) == frames;
+    if (golden != base.end() && same_run && golden->second != hex(results.front().hash)) {
+        std::cerr << "FAIL: output hash " << hex(results.front().hash)
+                  << " does not match golden " << golden->second << "\n";
+        rc = 1;
+    }
+    for (const auto& r : results) {
+        if (r.backend == kReference) continue;
+        auto it = base.find(ratio_key(r));
+        if (it == base.end() || ref_fps <= 0.0) {
+            std::cout << "  " << r.backend << ": no " << ratio_key(r)
+                      << " baseline recorded, skipping throughput check\n";
+            continue;
+        }
+        const double ref = std::stod(it->second);
+        const double ratio = r.fps / ref_fps;
+        const double floor_ratio = ref * (1.0 - tolerance);
+        std::cout << "  " << r.backend << ": " << std::fixed << std::setprecision(3) << ratio << "x "
+                  << kReference << " vs baseline " << ref << "x (min " << floor_ratio << "x)\n";
+        if (ratio < floor_ratio) {
+            std::cerr << "FAIL: " << r.backend << " throughput relative to " << kReference << " regressed by "
+                      << std::setprecision(1) << 100.0 * (1.0 - ratio / ref) << "%\n";
+            rc = 1;
+        }
+    }
+    return rc;
+}
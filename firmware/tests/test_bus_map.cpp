@@ -0,0 +1,95 @@
+#include <catch2/catch_all.hpp>
+
+#include "solution/src/can_decode.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+using namespace rbk;
+
+TEST_CASE("BusMap: builtin matches the old can/vcan mapping") {
+    const BusMap& m = BusMap::builtin();
+    REQUIRE(m.size() == 3);
+    CHECK(m.lookup("can0") == 0);
+    CHECK(m.lookup("vcan0") == 0);
+    CHECK(m.lookup("can1") == 1);
+    CHECK(m.lookup("vcan2") == 2);
+    CHECK(m.lookup("can3") == kNoBus);
+    CHECK(m.lookup("can") == kNoBus);
+    CHECK(m.lookup("vcan00") == kNoBus);
+    CHECK(m.lookup("") == kNoBus);
+    CHECK(m.lookup("a_very_long_interface_name") == kNoBus);
+}
+
+TEST_CASE("BusMap: many buses resolve without collisions") {
+    BusMap m;
+    for (int b = 0; b < 64; ++b) {
+        BusConfig bc;
+        bc.name = "can" + std::to_string(b);
+        bc.dbc = "bus" + std::to_string(b) + ".dbc";
+        bc.aliases = {"vcan" + std::to_string(b), "slcan" + std::to_string(b)};
+        REQUIRE(m.add(bc));
+    }
+    for (int b = 0; b < 64; ++b) {
+        CHECK(m.lookup("can" + std::to_string(b)) == b);
+        CHECK(m.lookup("vcan" + std::to_string(b)) == b);
+        CHECK(m.lookup("slcan" + std::to_string(b)) == b);
+    }
+    CHECK(m.lookup("can64") == kNoBus);
+
+    std::string err;
+    CHECK_FALSE(m.add({"vcan3", "x.dbc", {}}, &err));
+    CHECK(err.find("twice") != std::string::npos);
+    CHECK_FALSE(m.add({"new", "x.dbc", {"new"}}, &err));
+    CHECK_FALSE(m.add({"", "x.dbc", {}}, &err));
+}
+
+TEST_CASE("BusMap: config file") {
+    const std::string path = "rbk_buses_test.conf";
+    {
+        std::ofstream os(path);
+        os << "# six-bus car\n"
+              "can0 a.dbc vcan0\n"
+              "\n"
+              "can1 b.dbc   # trailing comment\n"
+              "chassis c.dbc can2 vcan2\n"
+              "can3 d.dbc\ncan4 e.dbc\ncan5 f.dbc\n";
+    }
+    BusMap m;
+    std::string err;
+    REQUIRE(m.load(path, &err));
+    CHECK(m.size() == 6);
+    CHECK(m.bus(2).name == "chassis");
+    CHECK(m.bus(2).dbc == "c.dbc");
+    CHECK(m.lookup("vcan2") == 2);
+    CHECK(m.lookup("can5") == 5);
+
+    {
+        std::ofstream os(path);
+        os << "can0\n";
+    }
+    BusMap bad;
+    CHECK_FALSE(bad.load(path, &err));
+    CHECK(err.find(":1: missing DBC") != std::string::npos);
+    std::remove(path.c_str());
+
+    CHECK_FALSE(bad.load("does-not-exist.conf", &err));
+}
+
+TEST_CASE("parse_line: resolves the bus index through the map") {
+    BusMap m;
+    REQUIRE(m.add({"pt", "pt.dbc", {"vcan7"}}));
+    ParsedLine pl;
+    REQUIRE(parse_line("(1.5) vcan7 123#00", pl, m));
+    CHECK(pl.bus == 0);
+    CHECK(pl.iface.empty()); // not materialised on this path
+    REQUIRE(parse_line("(1.5) can0 123#00", pl, m));
+    CHECK(pl.bus == kNoBus);
+
+    REQUIRE(parse_line("(1.5) vcan1 123#00", pl));
+    CHECK(pl.bus == 1);
+    CHECK(pl.iface == "can1");
+    // A ParsedLine reused across both overloads does not keep a stale name.
+    REQUIRE(parse_line("(1.5) vcan7 123#00", pl, m));
+    CHECK(pl.iface.empty());
+}
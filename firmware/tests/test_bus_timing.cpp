@@ -0,0 +1,166 @@
+#include <catch2/catch_all.hpp>
+
+#include "solution/src/bus_timing.hpp"
+#include "solution/src/dbc_simple.hpp"
+#include "tests/test_util.hpp"
+#include <sstream>
+#include <vector>
+
+#ifndef RBK_DBC_DIR
+#define RBK_DBC_DIR "dbc-files"
+#endif
+
+using namespace rbk;
+using namespace rbk::test;
+
+namespace {
+
+const char* kDbc = R"DBC(
+VERSION ""
+NS_ :
+BS_:
+BU_: INV
+BO_ 176 M176_Fast_Info: 8 INV
+ SG_ Speed : 0|16@1- (1,0) [0|0] "rpm" INV
+BO_ 171 M171_Fault_Codes: 8 INV
+ SG_ Post : 0|16@1+ (1,0) [0|0] "" INV
+BA_DEF_ BO_  "GenMsgCycleTime" INT 0 100000;
+BA_DEF_DEF_  "GenMsgCycleTime" 0;
+BA_ "GenMsgCycleTime" BO_ 176 10;
+)DBC";
+
+ParsedLine frame(uint32_t id, int64_t ts_ns) {
+    ParsedLine pl;
+    pl.ts_ns = ts_ns;
+    pl.iface = "can2";
+    pl.can_id = id;
+    pl.data.assign(8, 0);
+    return pl;
+}
+
+} // namespace
+
+TEST_CASE("cycle_time_ms: GenMsgCycleTime from both DBC loaders") {
+    auto net = load_net(kDbc);
+    REQUIRE(net);
+    for (const dbcppp::IMessage& m : net->Messages()) {
+        CHECK(cycle_time_ms(m) == (m.Id() == 176 ? 10u : 0u));
+    }
+
+    stage4::Network s4;
+    REQUIRE(stage4::parse_dbc_file(RBK_DBC_DIR "/TractiveBus.dbc", s4));
+    CHECK(s4.msgs.at(176).cycle_time_ms == 3);   // M176_Fast_Info
+    CHECK(s4.msgs.at(166).cycle_time_ms == 10);  // M166_Current_Info
+    CHECK(s4.msgs.at(171).cycle_time_ms == 100); // M171_Fault_Codes
+}
+
+TEST_CASE("BusTiming: jitter, late and missed frames against the declared cycle") {
+    auto net = load_net(kDbc);
+    REQUIRE(net);
+
+    std::vector<TimingAlert> alerts;
+    BusTiming bt;
+    bt.declare_network(2, *net);
+    bt.set_alert_handler([&](const TimingAlert& a) { alerts.push_back(a); });
+
+    // 10 ms cycle, frames 0..9 on time, then frames 10..12 lost
+    const int64_t ms = 1000000;
+    int64_t t = 1000 * ms;
+    for (int i = 0; i < 10; ++i, t += 10 * ms) bt.observe(2, frame(176, t));
+    t += 30 * ms;
+    bt.observe(2, frame(176, t));
+    bt.finish();
+
+    const IdTiming* fast = nullptr;
+    for (const auto& id : bt.ids()) {
+        if (id.can_id == 176) fast = &id;
+    }
+    REQUIRE(fast);
+    CHECK(fast->name == "M176_Fast_Info");
+    CHECK(fast->frames == 11);
+    CHECK(fast->min_gap_ns == 10 * ms);
+    CHECK(fast->max_gap_ns == 40 * ms);
+    CHECK(fast->late == 1);
+    CHECK(fast->missed == 3);
+    CHECK(fast->gap_mean_ns == Catch::Approx(13.0 * ms));
+    CHECK(fast->jitter_ns() > 0.0);
+    CHECK(fast->hist[14] == 9);  // 10 ms = 10000 us -> [8192, 16384) us
+    CHECK(fast->hist[16] == 1);  // 40 ms
+
+    REQUIRE(alerts.size() == 1);
+    CHECK(alerts[0].kind == TimingAlert::Kind::Late);
+    CHECK(alerts[0].gap_ns == 40 * ms);
+
+    std::ostringstream os;
+    bt.write_report(os);
+    CHECK(os.str().find("M176_Fast_Info") != std::string::npos);
+    CHECK(os.str().find("bus 2 load") != std::string::npos);
+}
+
+TEST_CASE("BusTiming: missing-frame and bus-load alerts") {
+    auto net = load_net(kDbc);
+    REQUIRE(net);
+
+    TimingConfig cfg;
+    cfg.bitrate = 125000;
+    cfg.load_window_ns = 100000000LL; // 100 ms
+    cfg.load_alert = 0.5;
+    BusTiming bt(cfg);
+    bt.declare_network(2, *net);
+    std::vector<TimingAlert> alerts;
+    bt.set_alert_handler([&](const TimingAlert& a) { alerts.push_back(a); });
+
+    const int64_t ms = 1000000;
+    bt.observe(2, frame(176, 0));
+    // Only 0xAB keeps talking, 111 bits every 0.5 ms = 222 kbit/s on a 125 kbit/s bus
+    for (int64_t t = ms; t <= 250 * ms; t += ms / 2) bt.observe(2, frame(171, t));
+
+    bool missing = false, load = false;
+    for (const auto& a : alerts) {
+        if (a.kind == TimingAlert::Kind::Missing && a.can_id == 176) missing = true;
+        if (a.kind == TimingAlert::Kind::BusLoad) load = true;
+    }
+    CHECK(missing);
+    CHECK(load);
+    CHECK(BusTiming::frame_bits(0x0AB, 8) == 111);
+    CHECK(BusTiming::frame_bits(0x18394A85, 8) == 131);
+    CHECK(bt.buses()[2].peak > 1.0);
+}
+
+TEST_CASE("BusTiming: a bus that stops altogether is reported by tick and finish") {
+    auto net = load_net(kDbc);
+    REQUIRE(net);
+
+    const int64_t ms = 1000000;
+    auto run = [&](BusTiming& bt, std::vector<TimingAlert>& alerts) {
+        bt.declare_network(1, *net);
+        bt.declare_network(2, *net);
+        bt.set_alert_handler([&](const TimingAlert& a) { alerts.push_back(a); });
+        // Both buses at 10 ms; bus 2 goes silent after 50 ms, bus 1 runs on.
+        for (int64_t t = 0; t <= 500 * ms; t += 10 * ms) {
+            bt.observe(1, frame(176, t));
+            if (t <= 50 * ms) bt.observe(2, frame(176, t));
+        }
+    };
+
+    std::vector<TimingAlert> alerts;
+    BusTiming bt;
+    run(bt, alerts);
+    CHECK(alerts.empty());  // no frame on bus 2 to notice it
+    bt.tick(505 * ms);
+    REQUIRE(alerts.size() == 1);
+    CHECK(alerts[0].kind == TimingAlert::Kind::Missing);
+    CHECK(alerts[0].bus == 2);
+    CHECK(alerts[0].gap_ns == 455 * ms);
+    bt.tick(600 * ms);      // bus 1 is now quiet too; bus 2 is not raised again
+    REQUIRE(alerts.size() == 2);
+    CHECK(alerts[1].bus == 1);
+
+    std::vector<TimingAlert> at_end;
+    BusTiming ended;
+    run(ended, at_end);
+    ended.finish();
+    REQUIRE(at_end.size() == 1);
+    CHECK(at_end[0].bus == 2);
+    CHECK(at_end[0].ts_ns == 500 * ms);
+}
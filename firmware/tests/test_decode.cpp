@@ -2,6 +2,10 @@
 #include <catch2/catch_all.hpp>
 
 #include "solution/src/can_decode.hpp"
+#include "solution/src/sample_sink.hpp"
+#include "solution/src/timestamp.hpp"
+#include <cstdio>
+#include <iomanip>
 #include <sstream>
 #include <string>
 #include <cstring>
@@ -13,7 +17,7 @@ using Catch::Approx; // <-- bring Approx into scope
 TEST_CASE("parse_line: valid") {
     ParsedLine pl;
     REQUIRE(parse_line("(1705638799.992057) vcan0  705#B1B8E3680F488B72", pl));
-    CHECK(pl.timestamp == Approx(1705638799.992057));
+    CHECK(pl.ts_ns == 1705638799992057000LL);
     CHECK(pl.iface == "can0"); // canonicalized
     CHECK(pl.can_id == 0x705);
     REQUIRE(pl.data.size() == 8);
@@ -58,7 +62,7 @@ BO_ 256 Msg: 8 ECU
 
     // Prepare a payload buffer
     ParsedLine pl;
-    pl.timestamp = 1.23;
+    pl.ts_ns = 1230000000LL;
     pl.iface = "can0";
     pl.can_id = 0x100;
     // We'll still use the same bytes; the expected value will be calculated by dbcppp itself
@@ -103,7 +107,7 @@ BO_ 512 Msg: 8 ECU
     const dbcppp::ISignal& sig = *msg->Signals().begin();
 
     ParsedLine pl;
-    pl.timestamp = 2.5;
+    pl.ts_ns = 2500000000LL;
     pl.iface = "can1";
     pl.can_id = 0x200;
 
@@ -155,7 +159,7 @@ BO_ 291 MsgB: 8 ECU
     auto mapB = build_msg_map(*netB);
 
     ParsedLine pl;
-    pl.timestamp = 9.0;
+    pl.ts_ns = 9000000000LL;
     pl.can_id = 0x123;
     pl.data = {0x05,0,0,0,0,0,0,0};
 
@@ -171,3 +175,132 @@ BO_ 291 MsgB: 8 ECU
     REQUIRE(decode_and_write(pl, *netB, mapB, os2) == 1);
     CHECK(os2.str() == "(9): NameB: 5\n");
 }
+
+
+TEST_CASE("decode_frame: TextSink matches decode_and_write across buses") {
+    const char* dbcA = R"DBC(
+VERSION ""
+NS_ :
+BS_:
+BU_: ECU
+BO_ 291 MsgA: 8 ECU
+ SG_ NameA : 0|8@1+ (1,0) [0|255] "" ECU
+ SG_ WordA : 8|16@1- (0.5,-1) [0|0] "" ECU
+)DBC";
+    const char* dbcB = R"DBC(
+VERSION ""
+NS_ :
+BS_:
+BU_: ECU
+BO_ 291 MsgB: 8 ECU
+ SG_ NameB : 0|8@1+ (1,0) [0|255] "" ECU
+)DBC";
+
+    auto netA = load_dbc_from_string(dbcA);
+    auto netB = load_dbc_from_string(dbcB);
+    REQUIRE(netA);
+    REQUIRE(netB);
+
+    SignalCatalog cat;
+    REQUIRE(cat.add_bus(*netA) == 0);
+    REQUIRE(cat.add_bus(*netB) == 1);
+    REQUIRE(cat.size() == 3);
+    CHECK(cat.index_of("WordA") == 1);
+    CHECK(cat.index_of(1, "NameB") == 2);
+    CHECK(cat.index_of("missing") == -1);
+
+    ParsedLine pl;
+    pl.ts_ns = 1705638799992057000LL;
+    pl.can_id = 0x123;
+    pl.data = {0x05, 0xFE, 0xFF, 0, 0, 0, 0, 0};
+
+    std::ostringstream expected, got;
+    expected << std::setprecision(15);
+    got << std::setprecision(15);
+    decode_and_write(pl, *netA, build_msg_map(*netA), expected);
+    decode_and_write(pl, *netB, build_msg_map(*netB), expected);
+
+    TextSink text(cat, got);
+    CHECK(decode_frame(pl, 0, cat, text) == 2);
+    CHECK(decode_frame(pl, 1, cat, text) == 1);
+    CHECK(decode_frame(pl, 2, cat, text) == 0); // unknown bus
+    CHECK(got.str() == expected.str());
+    CHECK(got.str() == "(1705638799.99206): NameA: 5\n"
+                       "(1705638799.99206): WordA: -2\n"
+                       "(1705638799.99206): NameB: 5\n");
+}
+
+
+TEST_CASE("parse_timestamp: integer nanoseconds") {
+    auto parse = [](const std::string& s) {
+        int64_t ns = -1;
+        REQUIRE(parse_timestamp(s.data(), s.data() + s.size(), ns));
+        return ns;
+    };
+    CHECK(parse("1705638799.992057") == 1705638799992057000LL);
+    CHECK(parse("1705638799.123456789") == 1705638799123456789LL); // kernel ns kept exactly
+    CHECK(parse("1705638799.1234567899") == 1705638799123456789LL); // sub-ns truncated
+    CHECK(parse("0.5") == 500000000LL);
+    CHECK(parse("9223372035.999999999") == 9223372035999999999LL); // largest that fits
+
+    int64_t ns = 0;
+    // 11+ second digits would overflow int64 nanoseconds
+    const std::string bad[] = {"", "12", ".5", "12.", "1a.5", "1.5x", "17056387990.5", "9999999999.5", "99999999999999999999.5"};
+    for (const auto& s : bad) CHECK_FALSE(parse_timestamp(s.data(), s.data() + s.size(), ns));
+}
+
+TEST_CASE("format_timestamp: identical to the old %.15g of a double") {
+    auto old_fmt = [](int64_t ns) {
+        char dec[40], out[40];
+        std::snprintf(dec, sizeof(dec), "%lld.%09lld", static_cast<long long>(ns / 1000000000),
+                      static_cast<long long>(ns % 1000000000));
+        std::snprintf(out, sizeof(out), "%.15g", std::stod(dec));
+        return std::string(out);
+    };
+    auto new_fmt = [](int64_t ns) {
+        char buf[kTimestampBufLen];
+        return std::string(buf, format_timestamp(ns, buf));
+    };
+
+    CHECK(new_fmt(1705638799992057000LL) == "1705638799.99206");
+    CHECK(new_fmt(1230000000LL) == "1.23");
+    CHECK(new_fmt(9000000000LL) == "9");
+    CHECK(new_fmt(0) == "0");
+
+    // microsecond epoch stamps (incl. exact half-way ties) and raw nanosecond stamps
+    uint64_t x = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < 200000; ++i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        const int64_t sec = 1700000000 + static_cast<int64_t>(x % 100000000);
+        const int64_t us = static_cast<int64_t>((x >> 20) % 1000000);
+        const int64_t ns_us = sec * 1000000000LL + us * 1000;
+        const int64_t ns_tie = sec * 1000000000LL + (us / 10) * 10000 + 5000;
+        const int64_t ns_raw = sec * 1000000000LL + static_cast<int64_t>((x >> 7) % 1000000000);
+        const int64_t ns_small = static_cast<int64_t>(x % 100000000000000LL); // 0 .. 1e5 s
+        // within a few hundred ns of a rounding tie, and 10-digit seconds up to int64 range
+        const int64_t ns_near = ns_tie + static_cast<int64_t>((x >> 3) % 801) - 400;
+        const int64_t ns_far = static_cast<int64_t>(x % 8000000000ULL + 1000000000ULL) * 1000000000LL +
+                               (us / 10) * 10000 + 5000 + static_cast<int64_t>((x >> 5) % 4001) - 2000;
+        REQUIRE(new_fmt(ns_us) == old_fmt(ns_us));
+        REQUIRE(new_fmt(ns_near) == old_fmt(ns_near));
+        REQUIRE(new_fmt(ns_far) == old_fmt(ns_far));
+        REQUIRE(new_fmt(ns_tie) == old_fmt(ns_tie));
+        REQUIRE(new_fmt(ns_raw) == old_fmt(ns_raw));
+        REQUIRE(new_fmt(ns_small) == old_fmt(ns_small));
+    }
+}
+
+TEST_CASE("parse_line: accepts what the old regex accepted") {
+    ParsedLine pl;
+    REQUIRE(parse_line("(1.000000001)\tcan2 1#ABC\r", pl));
+    CHECK(pl.ts_ns == 1000000001LL);
+    CHECK(pl.iface == "can2");
+    CHECK(pl.can_id == 1);
+    REQUIRE(pl.data.size() == 1); // trailing nibble ignored
+    CHECK(pl.data[0] == 0xAB);
+
+    CHECK_FALSE(parse_line("(1.5)can0 1#00", pl));      // needs whitespace
+    CHECK_FALSE(parse_line("(1.5) can0 1#", pl));       // needs payload
+    CHECK_FALSE(parse_line("(1.5) can0 1#00 x", pl));   // trailing junk
+    CHECK_FALSE(parse_line("(1.5) can-0 1#00", pl));    // iface charset
+}
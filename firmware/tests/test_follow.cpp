@@ -0,0 +1,264 @@
+#include <catch2/catch_all.hpp>
+
+#include "solution/src/async_writer.hpp"
+#include "solution/src/bus_timing.hpp"
+#include "solution/src/checkpoint.hpp"
+#include "solution/src/latest_values.hpp"
+#include "solution/src/log_follower.hpp"
+#include "solution/src/range_check.hpp"
+#include "tests/test_util.hpp"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace rbk;
+using namespace rbk::test;
+
+namespace {
+
+void append(const std::string& path, const std::string& text) {
+    std::ofstream os(path, std::ios::binary | std::ios::app);
+    os << text;
+}
+
+std::vector<std::string> drain(LogFollower& f) {
+    std::vector<std::string> lines;
+    f.drain([&](const char* p, size_t n) { lines.emplace_back(p, n); });
+    return lines;
+}
+
+const char* kDbc = R"DBC(
+VERSION ""
+NS_ :
+BS_:
+BU_: ECU
+BO_ 256 Thermistors: 8 ECU
+ SG_ Temp_A : 0|8@1+ (1,-40) [-20|80] "degC" ECU
+ SG_ Temp_B : 8|8@1+ (1,-40) [-20|80] "degC" ECU
+BA_DEF_ BO_ "GenMsgCycleTime" INT 0 10000;
+BA_ "GenMsgCycleTime" BO_ 256 100;
+)DBC";
+
+struct Null : SampleSink {
+    void on_sample(const Sample&) override {}
+};
+
+// Every stateful sink the decoder checkpoints, fed the same frames.
+struct Pipeline {
+    explicit Pipeline(const SignalCatalog& cat) : cat(cat), latest(cat), range(cat, latest) {}
+
+    void feed(int from, int to) {
+        for (int i = from; i < to; ++i) {
+            ParsedLine pl;
+            pl.ts_ns = kT0 + i * 100000000LL + (i % 7) * 3000000LL;
+            pl.can_id = 0x100;
+            pl.bus = 0;
+            pl.data = {static_cast<uint8_t>(i % 150), static_cast<uint8_t>(60 + i % 3), 0, 0, 0, 0, 0, 0};
+            timing.observe(0, pl);
+            decode_frame(pl, 0, cat, range);
+        }
+    }
+
+    std::string state() const {
+        std::ostringstream os;
+        timing.save_state(os);
+        latest.save_state(os);
+        range.save_state(os);
+        return os.str();
+    }
+
+    std::vector<Checkpointable*> parts() { return {&timing, &latest, &range}; }
+
+    const SignalCatalog& cat;
+    BusTiming timing;
+    LatestValueTable latest;
+    RangeFilter range;
+};
+
+} // namespace
+
+TEST_CASE("follower holds back a partial last line", "[follow]") {
+    const std::string path = temp_path("follow_partial");
+    std::remove(path.c_str());
+    append(path, "one\ntwo\nthr");
+
+    LogFollower f(path);
+    REQUIRE(f.ok());
+    CHECK(drain(f) == std::vector<std::string>{"one", "two"});
+    CHECK(f.offset() == 8);
+
+    std::string tail;
+    REQUIRE(f.partial(tail));
+    CHECK(tail == "thr");
+
+    append(path, "ee\nfour\n");
+    CHECK(drain(f) == std::vector<std::string>{"three", "four"});
+    CHECK(f.offset() == 19);
+    CHECK_FALSE(f.partial(tail));
+    CHECK_FALSE(f.wait(0));
+
+    // Resume from a saved offset.
+    LogFollower g(path, 8);
+    CHECK(drain(g) == std::vector<std::string>{"three", "four"});
+    std::remove(path.c_str());
+}
+
+TEST_CASE("follower restarts on truncation and replacement", "[follow]") {
+    const std::string path = temp_path("follow_rotate");
+    std::remove(path.c_str());
+    append(path, "aaaaaaaa\nbbbbbbbb\n");
+
+    LogFollower f(path);
+    CHECK(drain(f).size() == 2);
+
+    { std::ofstream trunc(path, std::ios::binary | std::ios::trunc); }
+    append(path, "c\n");
+    CHECK(drain(f) == std::vector<std::string>{"c"});
+    CHECK(f.rotations() == 1);
+    CHECK(f.offset() == 2);
+
+    const std::string next = path + ".new";
+    append(next, "d\ne\n");
+    REQUIRE(std::rename(next.c_str(), path.c_str()) == 0);
+    CHECK(drain(f) == std::vector<std::string>{"d", "e"});
+    CHECK(f.rotations() == 2);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("follower notices a truncate that regrows past its offset", "[follow]") {
+    const std::string path = temp_path("follow_regrow");
+    std::remove(path.c_str());
+    append(path, "(1.000000) can0 100#01\n(2.000000) can0 100#02\n");
+
+    LogFollower f(path);
+    CHECK(drain(f).size() == 2);
+    CHECK(f.tail() == slurp(path));
+
+    // Between two drains the writer starts over and overtakes the old size.
+    { std::ofstream trunc(path, std::ios::binary | std::ios::trunc); }
+    append(path, "(9.000000) can0 100#09\n(9.100000) can0 100#0A\n(9.200000) can0 100#0B\n");
+    CHECK(drain(f).size() == 3);
+    CHECK(f.rotations() == 1);
+    CHECK(f.offset() == slurp(path).size());
+
+    // Plain growth is not mistaken for a rewrite.
+    append(path, "(9.300000) can0 100#0C\n");
+    CHECK(drain(f) == std::vector<std::string>{"(9.300000) can0 100#0C"});
+    CHECK(f.rotations() == 1);
+
+    // A resume offset whose bytes no longer match is caught before reading.
+    const std::string saved = f.tail();
+    CHECK(LogFollower::read_tail(path, f.offset()) == saved);
+    { std::ofstream trunc(path, std::ios::binary | std::ios::trunc); }
+    append(path, std::string(200, 'x') + "\n");
+    CHECK(LogFollower::read_tail(path, f.offset()) != saved);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("drain stops at its line budget and resumes at a line boundary", "[follow]") {
+    const std::string path = temp_path("follow_budget");
+    std::remove(path.c_str());
+    for (int i = 0; i < 10; ++i) append(path, "line" + std::to_string(i) + "\n");
+
+    LogFollower f(path);
+    std::vector<std::string> got;
+    auto take = [&](const char* p, size_t n) { got.emplace_back(p, n); };
+    CHECK(f.drain(take, 4) == 4);
+    CHECK(f.offset() == 4 * 6);
+    CHECK(f.tail() == slurp(path).substr(0, 24));
+    CHECK(f.drain(take, 4) == 4);
+    CHECK(f.drain(take, 4) == 2);
+    REQUIRE(got.size() == 10);
+    CHECK(got.back() == "line9");
+    CHECK(f.offset() == 60);
+    CHECK(f.rotations() == 0);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("checkpointed sinks resume to the uninterrupted state", "[follow]") {
+    DbcFixture fx(kDbc);
+    SignalCatalog& cat = fx.cat;
+
+    Pipeline straight(cat);
+    straight.timing.declare_network(0, *fx.net);
+    straight.feed(0, 400);
+
+    const std::string path = temp_path("follow_ckpt");
+    {
+        Pipeline first(cat);
+        first.timing.declare_network(0, *fx.net);
+        first.feed(0, 250);
+        CheckpointHeader hdr;
+        hdr.log = "dump.log";
+        hdr.offset = 12345;
+        hdr.log_tail = std::string("ab\n\0\xff", 5);
+        hdr.lines = 250;
+        hdr.output_bytes = 999;
+        auto parts = first.parts();
+        REQUIRE(write_checkpoint(path, hdr, {parts.begin(), parts.end()}));
+    }
+
+    Pipeline second(cat);
+    second.timing.declare_network(0, *fx.net);
+    CheckpointHeader hdr;
+    std::vector<std::string> skipped;
+    REQUIRE(read_checkpoint(path, hdr, second.parts(), &skipped));
+    CHECK(skipped.empty());
+    CHECK(hdr.log == "dump.log");
+    CHECK(hdr.offset == 12345);
+    CHECK(hdr.log_tail == std::string("ab\n\0\xff", 5));
+    CHECK(hdr.lines == 250);
+    CHECK(hdr.output_bytes == 999);
+    second.feed(250, 400);
+
+    CHECK(second.state() == straight.state());
+    CHECK(second.range.violations() == straight.range.violations());
+    CHECK(second.timing.ids()[0].frames == 400);
+
+    // A different catalog rejects the per-signal sections.
+    SignalCatalog other;
+    other.add_bus(*fx.net);
+    other.add_bus(*fx.net);
+    LatestValueTable wrong(other);
+    std::vector<Checkpointable*> only{&wrong};
+    REQUIRE(read_checkpoint(path, hdr, only, &skipped));
+    CHECK(skipped == std::vector<std::string>{"latest_values"});
+
+    // A torn file is refused as a whole.
+    const std::string body = slurp(path);
+    { std::ofstream torn(path, std::ios::binary | std::ios::trunc); torn << body.substr(0, body.size() / 2); }
+    std::string err;
+    CHECK_FALSE(read_checkpoint(path, hdr, second.parts(), nullptr, &err));
+    CHECK_FALSE(err.empty());
+    std::remove(path.c_str());
+}
+
+TEST_CASE("async writer flushes and resumes at an offset", "[follow]") {
+    const std::string path = temp_path("follow_resume");
+    WriterConfig cfg;
+    cfg.buffer_bytes = 4096;
+    {
+        AsyncFileWriter w(path, cfg);
+        REQUIRE(w.ok());
+        std::ostream os(&w);
+        os << "keep me\n" << "drop me\n";
+        REQUIRE(w.flush());
+        CHECK(slurp(path) == "keep me\ndrop me\n");
+        CHECK(w.size() == 16);
+        os << "more";
+        CHECK(w.size() == 20);
+        REQUIRE(w.close());
+    }
+    cfg.resume_offset = 8;
+    {
+        AsyncFileWriter w(path, cfg);
+        REQUIRE(w.ok());
+        std::ostream os(&w);
+        os << "appended\n";
+        REQUIRE(w.close());
+    }
+    CHECK(slurp(path) == "keep me\nappended\n");
+    std::remove(path.c_str());
+}
@@ -0,0 +1,110 @@
+#include <catch2/catch_all.hpp>
+
+#include "solution/src/frame_memo.hpp"
+#include "tests/test_util.hpp"
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+using namespace rbk;
+using namespace rbk::test;
+
+namespace {
+
+const char* kDbc = R"DBC(
+VERSION ""
+NS_ :
+BS_:
+BU_: ECU
+BO_ 256 Status: 8 ECU
+ SG_ Temp : 0|8@1+ (1,-40) [0|0] "" ECU
+ SG_ Volt : 8|16@1+ (0.1,0) [0|0] "" ECU
+BO_ 512 Muxed: 8 ECU
+ SG_ Sel M : 0|8@1+ (1,0) [0|0] "" ECU
+ SG_ A m0 : 8|16@1+ (1,0) [0|0] "" ECU
+ SG_ B m1 : 8|16@1- (1,0) [0|0] "" ECU
+)DBC";
+
+ParsedLine frame(uint32_t id, int64_t ts_ns, std::vector<uint8_t> data) {
+    ParsedLine pl;
+    pl.ts_ns = ts_ns;
+    pl.iface = "can0";
+    pl.can_id = id;
+    pl.data = std::move(data);
+    return pl;
+}
+
+} // namespace
+
+TEST_CASE("FrameMemo: repeated payloads hit and emit the same samples") {
+    DbcFixture fx(kDbc);
+    SignalCatalog& cat = fx.cat;
+    REQUIRE(cat.message_count() == 2);
+
+    const std::vector<ParsedLine> frames = {
+        frame(0x100, 1000, {50, 0x10, 0x27, 0, 0, 0, 0, 0}),
+        frame(0x100, 2000, {50, 0x10, 0x27, 0, 0, 0, 0, 0}), // hit
+        frame(0x200, 3000, {0, 0x34, 0x12, 0, 0, 0, 0, 0}),
+        frame(0x200, 4000, {1, 0x34, 0x12, 0, 0, 0, 0, 0}),  // mux switch changes
+        frame(0x200, 5000, {1, 0x34, 0x12, 0, 0, 0, 0, 0}),  // hit
+        frame(0x100, 6000, {50, 0x10, 0x27, 0, 0, 0, 0, 0}), // hit across other IDs
+        frame(0x100, 7000, {50, 0x10, 0x27, 0, 0, 0, 0}),    // shorter DLC: miss
+        frame(0x100, 8000, {51, 0x10, 0x27, 0, 0, 0, 0}),
+        frame(0x999, 9000, {1, 2, 3}),                       // unknown ID
+    };
+
+    Recorder plain, memoised;
+    FrameMemo memo(cat);
+    for (const auto& pl : frames) {
+        CHECK(decode_frame(pl, 0, cat, memoised, memo) == decode_frame(pl, 0, cat, plain));
+    }
+
+    REQUIRE(memoised.got.size() == plain.got.size());
+    CHECK(memoised.frames == plain.frames);
+    for (size_t i = 0; i < plain.got.size(); ++i) {
+        CHECK(memoised.got[i].ts_ns == plain.got[i].ts_ns);
+        CHECK(memoised.got[i].signal == plain.got[i].signal);
+        CHECK(memoised.got[i].value == plain.got[i].value);
+    }
+
+    CHECK(memo.stats().hits == 3);
+    CHECK(memo.stats().misses == 5);
+    CHECK(memo.stats().hit_rate() == Catch::Approx(3.0 / 8.0));
+    CHECK(memo.stats().timed_misses == 1); // only the first of 256
+}
+
+TEST_CASE("FrameMemo: FD payloads compare past the first eight bytes") {
+    DbcFixture fx(kDbc);
+    SignalCatalog& cat = fx.cat;
+    FrameMemo memo(cat);
+    Recorder rec;
+
+    std::vector<uint8_t> fd(16, 0);
+    decode_frame(frame(0x100, 1, fd), 0, cat, rec, memo);
+    fd[12] = 7;
+    decode_frame(frame(0x100, 2, fd), 0, cat, rec, memo);
+    decode_frame(frame(0x100, 3, fd), 0, cat, rec, memo);
+    CHECK(memo.stats().misses == 2);
+    CHECK(memo.stats().hits == 1);
+}
+
+TEST_CASE("TextSink: cached value text matches fresh rendering") {
+    DbcFixture fx(kDbc);
+    SignalCatalog& cat = fx.cat;
+
+    std::ostringstream expected, got;
+    expected << std::setprecision(15);
+    TextSink text(cat, got);
+    FrameMemo memo(cat);
+    for (int i = 0; i < 6; ++i) {
+        const auto pl = frame(0x100, kT0 + i * 1000000LL,
+                              {static_cast<uint8_t>(i / 2), 0x01, 0x00, 0, 0, 0, 0, 0});
+        decode_frame(pl, 0, cat, text, memo);
+        expected << '(' << std::setprecision(15) << static_cast<double>(pl.ts_ns) / 1e9
+                 << "): Temp: " << (i / 2) - 40 << "\n";
+        expected << '(' << static_cast<double>(pl.ts_ns) / 1e9 << "): Volt: " << 0.1 << "\n";
+    }
+    CHECK(got.str() == expected.str());
+    CHECK(text.rendered() == 4); // Temp: 3 distinct values, Volt: 1
+    CHECK(text.reused() == 8);
+}
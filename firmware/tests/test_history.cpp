@@ -0,0 +1,162 @@
+#include <catch2/catch_all.hpp>
+
+#include "solution/src/signal_history.hpp"
+#include "tests/test_util.hpp"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace rbk;
+using namespace rbk::test;
+
+namespace {
+
+const char* kDbc = R"DBC(
+VERSION ""
+NS_ :
+BS_:
+BU_: ECU
+BO_ 256 Pack: 8 ECU
+ SG_ Pack_Voltage : 0|16@1+ (0.01,0) [0|0] "V" ECU
+ SG_ Pack_Current : 16|16@1- (0.1,0) [0|0] "A" ECU
+ SG_ Relay_State : 32|8@1+ (1,0) [0|0] "" ECU
+)DBC";
+
+bool same_bits(double a, double b) { return std::memcmp(&a, &b, sizeof(a)) == 0; }
+
+} // namespace
+
+TEST_CASE("history round-trips timestamps and values bit-exactly", "[history]") {
+    DbcFixture fx(kDbc);
+    SignalHistory h(fx.cat);
+
+    std::mt19937_64 rng(7);
+    std::vector<HistoryPoint> want[3];
+    double v = 400.0;
+    int64_t ts = kT0;
+    const double specials[] = {0.0, -0.0, std::numeric_limits<double>::infinity(),
+                               std::numeric_limits<double>::quiet_NaN(), 1e-310, -1e300};
+    for (int i = 0; i < 20000; ++i) {
+        ts += 10000000 + static_cast<int64_t>(rng() % 200) * 1000 - 100000; // 10 ms +-100 us
+        v += static_cast<double>(static_cast<int64_t>(rng() % 21) - 10) * 0.01;
+        const double cur = (i % 97 == 0) ? specials[(i / 97) % 6] : v;
+        const double raw = static_cast<double>(rng());
+        const double relay = (i / 1000) % 2;
+        h.append(0, ts, cur);
+        h.append(1, ts, raw);
+        h.append(2, ts, relay);
+        want[0].push_back({ts, cur});
+        want[1].push_back({ts, raw});
+        want[2].push_back({ts, relay});
+    }
+    // A backwards step must survive too.
+    h.append(2, ts - 5000000, 1.0);
+    want[2].push_back({ts - 5000000, 1.0});
+
+    for (uint32_t sig = 0; sig < 3; ++sig) {
+        std::vector<HistoryPoint> got;
+        REQUIRE(h.read(sig, INT64_MIN, INT64_MAX, got) == want[sig].size());
+        for (size_t i = 0; i < got.size(); ++i) {
+            INFO("signal " << sig << " sample " << i);
+            REQUIRE(got[i].ts_ns == want[sig][i].ts_ns);
+            REQUIRE(same_bits(got[i].value, want[sig][i].value));
+        }
+    }
+
+    const HistoryStats st = h.stats();
+    CHECK(st.samples == 60001);
+    CHECK(st.chunks > 3);
+    CHECK(st.bytes_per_sample() < 16.0); // random doubles are worse than raw
+}
+
+TEST_CASE("history range reads honour the window across chunks", "[history]") {
+    DbcFixture fx(kDbc);
+    SignalHistory h(fx.cat);
+    for (int i = 0; i < 5000; ++i) h.append(1, kT0 + i * 3000000LL, i * 0.5);
+
+    std::vector<HistoryPoint> got;
+    const int64_t from = kT0 + 1000 * 3000000LL;
+    const int64_t to = kT0 + 3999 * 3000000LL;
+    REQUIRE(h.read(1, from, to, got) == 3000);
+    CHECK(got.front().ts_ns == from);
+    CHECK(got.front().value == 500.0);
+    CHECK(got.back().ts_ns == to);
+    CHECK(got.back().value == 1999.5);
+
+    // Appends to `out`; empty and unknown ranges return nothing.
+    CHECK(h.read(1, to + 1, to + 2, got) == 0);
+    CHECK(h.read(0, INT64_MIN, INT64_MAX, got) == 0);
+    CHECK(h.read(99, INT64_MIN, INT64_MAX, got) == 0);
+    CHECK(got.size() == 3000);
+
+    // Timestamps are kept at ts_unit_ns.
+    h.append(2, kT0 + 1234567, 1.0);
+    got.clear();
+    REQUIRE(h.read(2, INT64_MIN, INT64_MAX, got) == 1);
+    CHECK(got[0].ts_ns == kT0 + 1234000);
+}
+
+TEST_CASE("slow periodic signals compress to a couple of bits", "[history]") {
+    DbcFixture fx(kDbc);
+    SignalHistory h(fx.cat);
+    // 333 Hz, +-20 us jitter, value changing every 500 samples.
+    std::mt19937 rng(1);
+    for (int i = 0; i < 100000; ++i) {
+        const int64_t jitter = static_cast<int64_t>(rng() % 41) * 1000 - 20000;
+        h.append(0, kT0 + i * 3003000LL + jitter, 380.0 + (i / 500) * 0.01);
+    }
+    const HistoryStats st = h.stats();
+    CHECK(st.samples == 100000);
+    CHECK(st.bits_per_sample() < 16.0);   // 1-2 bytes
+    CHECK(st.bytes_per_sample() < 2.0);   // including chunk headers and slack
+}
+
+TEST_CASE("history retention recycles chunks", "[history]") {
+    DbcFixture fx(kDbc);
+    HistoryConfig cfg;
+    cfg.retention_ns = 10 * kNsPerSec;
+    SignalHistory h(fx.cat, cfg);
+
+    std::mt19937_64 rng(3);
+    for (int i = 0; i < 20000; ++i) h.append(1, kT0 + i * 10000000LL, static_cast<double>(rng()));
+    const uint64_t bytes = h.stats().bytes;
+    for (int i = 20000; i < 60000; ++i) h.append(1, kT0 + i * 10000000LL, static_cast<double>(rng()));
+
+    const HistoryStats st = h.stats();
+    CHECK(st.bytes == bytes);      // steady state: no new chunks
+    CHECK(st.free_chunks > 0);
+
+    std::vector<HistoryPoint> got;
+    h.read(1, INT64_MIN, INT64_MAX, got);
+    REQUIRE(!got.empty());
+    CHECK(got.back().ts_ns == kT0 + 59999 * 10000000LL);
+    // Whole chunks are dropped, so at least the window and less than the
+    // window plus one chunk is left.
+    CHECK(got.back().ts_ns - got.front().ts_ns >= cfg.retention_ns);
+    CHECK(got.size() < 1000 + 100);
+}
+
+TEST_CASE("retention follows the newest sample on any signal", "[history]") {
+    DbcFixture fx(kDbc);
+    HistoryConfig cfg;
+    cfg.retention_ns = 10 * kNsPerSec;
+    SignalHistory h(fx.cat, cfg);
+
+    // Signal 0 goes quiet after 5 s; signal 1 keeps going for a minute.
+    for (int i = 0; i < 6000; ++i) {
+        const int64_t ts = kT0 + i * 10000000LL;
+        if (i < 500) h.append(0, ts, i * 0.5);
+        h.append(1, ts, 1.0);
+    }
+
+    std::vector<HistoryPoint> got;
+    CHECK(h.read(0, INT64_MIN, INT64_MAX, got) == 0);
+    REQUIRE(h.read(1, INT64_MIN, INT64_MAX, got) > 0);
+    CHECK(got.back().ts_ns - got.front().ts_ns >= cfg.retention_ns);
+    CHECK(got.front().ts_ns > kT0 + 500 * 10000000LL);  // signal 0's span was retired too
+    const HistoryStats st = h.stats();
+    CHECK(st.samples == got.size());
+    CHECK(st.free_chunks > 0);
+}
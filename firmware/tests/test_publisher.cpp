@@ -0,0 +1,206 @@
+#include <catch2/catch_all.hpp>
+
+#include "solution/src/json_publisher.hpp"
+#include "tests/test_util.hpp"
+#include <arpa/inet.h>
+#include <chrono>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+using namespace rbk;
+using namespace rbk::test;
+
+namespace {
+
+const char* kDbc = R"DBC(
+VERSION ""
+NS_ :
+BS_:
+BU_: ECU
+BO_ 256 Msg: 8 ECU
+ SG_ Temp : 0|8@1+ (1,0) [0|255] "C" ECU
+ SG_ Volt : 8|16@1+ (0.1,0) [0|6553.5] "V" ECU
+)DBC";
+
+// Listening socket on an ephemeral loopback port.
+struct Listener {
+    int fd = -1;
+    uint16_t port = 0;
+    explicit Listener(int backlog = 4) {
+        fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in a{};
+        a.sin_family = AF_INET;
+        a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ::bind(fd, reinterpret_cast<sockaddr*>(&a), sizeof(a));
+        ::listen(fd, backlog);
+        socklen_t len = sizeof(a);
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&a), &len);
+        port = ntohs(a.sin_port);
+    }
+    ~Listener() { ::close(fd); }
+};
+
+std::string read_all(int fd) {
+    std::string s;
+    char buf[4096];
+    ssize_t n;
+    while ((n = ::read(fd, buf, sizeof(buf))) > 0) s.append(buf, static_cast<size_t>(n));
+    return s;
+}
+
+} // namespace
+
+TEST_CASE("JsonPublisher: streams one JSON line per sample") {
+    DbcFixture fx(kDbc);
+    SignalCatalog& cat = fx.cat;
+
+    Listener l;
+    PublisherConfig cfg;
+    cfg.port = l.port;
+
+    ParsedLine pl;
+    pl.ts_ns = 1705638799500000000LL;
+    pl.can_id = 0x100;
+    pl.data = {25, 0xE8, 0x03, 0, 0, 0, 0, 0};
+
+    {
+        JsonPublisher pub(cat, cfg);
+        REQUIRE(decode_frame(pl, 0, cat, pub) == 2);
+        // As the range filter hands it on under RangePolicy::Flag.
+        Sample flagged;
+        flagged.ts_ns = pl.ts_ns;
+        flagged.signal = 0;
+        flagged.flags = kSampleOutOfRange;
+        flagged.value = 300.0;
+        pub.begin_frame(pl, 0);
+        pub.on_sample(flagged);
+        pub.end_frame();
+        REQUIRE(pub.flush());
+        const auto st = pub.stats();
+        CHECK(st.batches_sent == 2);
+        CHECK(st.samples_queued == 3);
+        CHECK(st.samples_dropped == 0);
+        CHECK(st.connects == 1);
+    }
+
+    const int c = ::accept(l.fd, nullptr, nullptr);
+    REQUIRE(c >= 0);
+    const std::string got = read_all(c);
+    ::close(c);
+
+    CHECK(got ==
+          "{\"timestamp\":1705638799500.000,\"bus\":0,\"signal\":\"Temp\",\"value\":25}\n"
+          "{\"timestamp\":1705638799500.000,\"bus\":0,\"signal\":\"Volt\",\"value\":100}\n"
+          "{\"timestamp\":1705638799500.000,\"bus\":0,\"signal\":\"Temp\",\"value\":300,\"out_of_range\":true}\n");
+}
+
+TEST_CASE("JsonPublisher: bounded queue drops oldest while disconnected") {
+    DbcFixture fx(kDbc);
+    SignalCatalog& cat = fx.cat;
+
+    // Grab a free port, then close it so every connect is refused.
+    uint16_t dead_port = 0;
+    { Listener l; dead_port = l.port; }
+
+    PublisherConfig cfg;
+    cfg.port = dead_port;
+    cfg.queue_batches = 4;
+    cfg.reconnect_min_ms = 50;
+
+    JsonPublisher pub(cat, cfg);
+    ParsedLine pl;
+    pl.can_id = 0x100;
+    pl.data = {1, 0, 0, 0, 0, 0, 0, 0};
+    for (int i = 0; i < 50; ++i) {
+        pl.ts_ns = i * 1000000000LL;
+        decode_frame(pl, 0, cat, pub);
+    }
+    const auto st = pub.stats();
+    CHECK(st.samples_queued == 100);
+    // At most the queue plus one in-flight batch survive.
+    CHECK(st.batches_dropped >= 45);
+    CHECK(st.batches_sent == 0);
+    CHECK_FALSE(pub.connected());
+}
+
+TEST_CASE("JsonPublisher: shutdown does not wait on a connect that never completes") {
+    DbcFixture fx(kDbc);
+    SignalCatalog& cat = fx.cat;
+
+    // A listener that never accepts, its queue filled: further SYNs are
+    // dropped, so a blocking connect() would hang for minutes.
+    Listener l(0);
+    sockaddr_in a{};
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    a.sin_port = htons(l.port);
+    std::vector<int> fillers;
+    for (int i = 0; i < 8; ++i) {
+        const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        ::fcntl(fd, F_SETFL, O_NONBLOCK);
+        ::connect(fd, reinterpret_cast<sockaddr*>(&a), sizeof(a));
+        fillers.push_back(fd);
+    }
+
+    PublisherConfig cfg;
+    cfg.port = l.port;
+    cfg.connect_timeout_ms = 100;
+    cfg.reconnect_min_ms = 50;
+    const auto t0 = std::chrono::steady_clock::now();
+    {
+        JsonPublisher pub(cat, cfg);
+        ParsedLine pl;
+        pl.can_id = 0x100;
+        pl.data = {1, 0, 0, 0, 0, 0, 0, 0};
+        decode_frame(pl, 0, cat, pub);
+        CHECK_FALSE(pub.flush(std::chrono::milliseconds(300)));
+    }
+    // The destructor's own flush() waits up to 2 s; nothing beyond that.
+    CHECK(std::chrono::steady_clock::now() - t0 < std::chrono::seconds(4));
+    for (int fd : fillers) ::close(fd);
+}
+
+TEST_CASE("JsonPublisher: shutdown does not wait on a peer that stops reading") {
+    DbcFixture fx(kDbc);
+    SignalCatalog& cat = fx.cat;
+
+    Listener l;
+    PublisherConfig cfg;
+    cfg.port = l.port;
+    cfg.flush_interval_ms = 60000;  // 64 KiB batches
+    const auto t0 = std::chrono::steady_clock::now();
+    int peer = -1;
+    {
+        JsonPublisher pub(cat, cfg);
+        ParsedLine pl;
+        pl.can_id = 0x100;
+        pl.data = {1, 0, 0, 0, 0, 0, 0, 0};
+        decode_frame(pl, 0, cat, pub);
+        REQUIRE(pub.flush());
+        peer = ::accept(l.fd, nullptr, nullptr);
+        REQUIRE(peer >= 0);
+        // Far more than the socket buffers hold; the peer never reads.
+        for (int i = 0; i < 300000; ++i) {
+            pl.ts_ns = kT0 + i * 1000000LL;
+            decode_frame(pl, 0, cat, pub);
+        }
+        CHECK_FALSE(pub.flush(std::chrono::milliseconds(300)));
+        CHECK(pub.connected());
+    }
+    CHECK(std::chrono::steady_clock::now() - t0 < std::chrono::seconds(4));
+    ::close(peer);
+}
+
+TEST_CASE("parse_publish_target") {
+    PublisherConfig cfg;
+    REQUIRE(parse_publish_target("streaming-service:12001", cfg));
+    CHECK(cfg.host == "streaming-service");
+    CHECK(cfg.port == 12001);
+    REQUIRE(parse_publish_target("localhost", cfg));
+    CHECK(cfg.host == "localhost");
+    CHECK_FALSE(parse_publish_target("host:99999", cfg));
+}
@@ -0,0 +1,173 @@
+#include <catch2/catch_all.hpp>
+
+#include "solution/src/dbc_simple.hpp"
+#include "solution/src/range_check.hpp"
+#include "tests/test_util.hpp"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+using namespace rbk;
+using namespace rbk::test;
+
+namespace {
+
+const char* kDbc = R"DBC(
+VERSION ""
+NS_ :
+BS_:
+BU_: ECU
+BO_ 256 Thermistors: 8 ECU
+ SG_ Temp_A : 0|8@1+ (1,-40) [-20|80] "degC" ECU
+ SG_ Temp_B : 8|8@1+ (1,-40) [-20|80] "degC" ECU
+ SG_ Raw : 16|8@1+ (1,0) [0|0] "" ECU
+)DBC";
+
+// One frame with Temp_A = a, Temp_B = b (physical), Raw = 200.
+ParsedLine frame(int64_t ts_ns, int a, int b) {
+    ParsedLine pl;
+    pl.ts_ns = ts_ns;
+    pl.can_id = 0x100;
+    pl.data = {static_cast<uint8_t>(a + 40), static_cast<uint8_t>(b + 40), 200, 0, 0, 0, 0, 0};
+    return pl;
+}
+
+} // namespace
+
+TEST_CASE("stage4 parses [min|max] and unit") {
+    std::ofstream("rbk_range_test.dbc") << kDbc;
+    stage4::Network net;
+    REQUIRE(stage4::parse_dbc_file("rbk_range_test.dbc", net));
+    std::remove("rbk_range_test.dbc");
+
+    const auto& sigs = net.msgs.at(256).signals;
+    REQUIRE(sigs.size() == 3);
+    CHECK(sigs[0].minimum == -20.0);
+    CHECK(sigs[0].maximum == 80.0);
+    CHECK(sigs[0].unit == "degC");
+    CHECK(sigs[0].has_limits());
+    CHECK_FALSE(sigs[2].has_limits()); // [0|0]
+    CHECK(sigs[2].unit.empty());
+}
+
+TEST_CASE("RangeFilter: policies") {
+    DbcFixture fx(kDbc);
+    SignalCatalog& cat = fx.cat;
+    Recorder rec;
+    RangeFilter filter(cat, rec);
+    CHECK(filter.limited_signals() == 2);
+    CHECK_FALSE(filter.has_limits(2));
+
+    SECTION("count passes values through") {
+        decode_frame(frame(1, 100, 20), 0, cat, filter);
+        REQUIRE(rec.got.size() == 3);
+        CHECK(rec.got[0].value == 100.0);
+        CHECK(rec.got[0].flags == 0);
+        CHECK(rec.got[2].value == 200.0); // Raw has no limits
+    }
+    SECTION("flag marks the sample") {
+        filter.set_policy(0, RangePolicy::Flag);
+        decode_frame(frame(1, 100, 20), 0, cat, filter);
+        REQUIRE(rec.got.size() == 3);
+        CHECK(rec.got[0].flags == kSampleOutOfRange);
+        CHECK(rec.got[1].flags == 0);
+    }
+    SECTION("clamp pins to the violated limit") {
+        REQUIRE(filter.set_policy("Temp_A", RangePolicy::Clamp));
+        REQUIRE(filter.set_policy("Temp_B", RangePolicy::Clamp));
+        decode_frame(frame(1, 100, -40), 0, cat, filter);
+        REQUIRE(rec.got.size() == 3);
+        CHECK(rec.got[0].value == 80.0);
+        CHECK(rec.got[1].value == -20.0);
+    }
+    SECTION("drop removes only the offending sample") {
+        filter.set_policy(1, RangePolicy::Drop);
+        decode_frame(frame(1, 20, 100), 0, cat, filter);
+        REQUIRE(rec.got.size() == 2);
+        CHECK(rec.got[0].signal == 0);
+        CHECK(rec.got[1].signal == 2);
+        CHECK(filter.dropped() == 1);
+    }
+    CHECK_FALSE(filter.set_policy("Nope", RangePolicy::Drop));
+}
+
+TEST_CASE("RangeFilter: per-signal summary") {
+    DbcFixture fx(kDbc);
+    SignalCatalog& cat = fx.cat;
+    Recorder rec;
+    RangeFilter filter(cat, rec);
+
+    decode_frame(frame(1000, 20, 20), 0, cat, filter);
+    decode_frame(frame(2000, 90, 20), 0, cat, filter);
+    decode_frame(frame(3000, -30, 20), 0, cat, filter);
+    decode_frame(frame(4000, 120, -25), 0, cat, filter);
+
+    CHECK(filter.checked() == 12);
+    CHECK(filter.violations() == 4);
+    const auto& a = filter.violations(0);
+    CHECK(a.above == 2);
+    CHECK(a.below == 1);
+    CHECK(a.lowest == -30.0);
+    CHECK(a.highest == 120.0);
+    CHECK(a.first_ns == 2000);
+    CHECK(a.last_ns == 4000);
+    CHECK(filter.violations(1).below == 1);
+
+    std::ostringstream os;
+    filter.write_summary(os);
+    const std::string s = os.str();
+    CHECK(s.find("Temp_A") < s.find("Temp_B")); // most violations first
+    CHECK(s.find("Raw") == std::string::npos);
+    CHECK(s.find("checked 12 samples, 4 out of range on 2 signals") != std::string::npos);
+}
+
+TEST_CASE("RangeFilter: SIMD batch agrees with a scalar check") {
+    // Many signals in one frame so the vector loop, its tail and a batch
+    // flush mid-frame are all exercised; includes NaN and the exact limits.
+    std::ostringstream dbc;
+    dbc << "VERSION \"\"\nNS_ :\nBS_:\nBU_: ECU\nBO_ 1 Wide: 64 ECU\n";
+    for (int i = 0; i < 67; ++i) dbc << " SG_ S" << i << " : 0|8@1+ (1,0) [-1|1] \"\" ECU\n";
+    auto net = load_net(dbc.str().c_str());
+    REQUIRE(net);
+    SignalCatalog cat;
+    cat.add_bus(*net);
+    Recorder rec;
+    RangeFilter filter(cat, rec, RangePolicy::Flag);
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double vals[] = {-1.0, 1.0, 0.0, 1.0000001, -1.0000001, nan, 5.0, -5.0, 0.5};
+    ParsedLine pl;
+    filter.begin_frame(pl, 0);
+    for (uint32_t i = 0; i < 67; ++i) {
+        Sample s;
+        s.signal = i;
+        s.value = vals[i % 9];
+        filter.on_sample(s);
+    }
+    filter.end_frame();
+
+    REQUIRE(rec.got.size() == 67);
+    for (uint32_t i = 0; i < 67; ++i) {
+        const double v = vals[i % 9];
+        const bool out = !(v >= -1.0 && v <= 1.0);
+        INFO("signal " << i << " value " << v);
+        CHECK(rec.got[i].signal == i);
+        CHECK(((rec.got[i].flags & kSampleOutOfRange) != 0) == out);
+    }
+}
+
+TEST_CASE("TextSink marks flagged samples") {
+    DbcFixture fx(kDbc);
+    SignalCatalog& cat = fx.cat;
+    std::ostringstream os;
+    TextSink text(cat, os);
+    RangeFilter filter(cat, text, RangePolicy::Flag);
+
+    decode_frame(frame(kT0, 90, 20), 0, cat, filter);
+    CHECK(os.str() == "(1705638799): Temp_A: 90 [out of range]\n"
+                      "(1705638799): Temp_B: 20\n"
+                      "(1705638799): Raw: 200\n");
+}
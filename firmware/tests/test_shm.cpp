@@ -0,0 +1,181 @@
+#include <catch2/catch_all.hpp>
+
+#include "solution/src/shm_ring.hpp"
+#include "tests/test_util.hpp"
+#include <memory>
+#include <string>
+#include <unistd.h>
+
+using namespace rbk;
+using namespace rbk::test;
+
+namespace {
+
+const char* kDbcA = R"DBC(
+VERSION ""
+NS_ :
+BS_:
+BU_: ECU
+BO_ 256 MsgA: 8 ECU
+ SG_ Temp : 0|8@1+ (1,0) [0|255] "C" ECU
+ SG_ Volt : 8|16@1+ (0.1,0) [0|6553.5] "V" ECU
+)DBC";
+
+const char* kDbcB = R"DBC(
+VERSION ""
+NS_ :
+BS_:
+BU_: ECU
+BO_ 512 MsgB: 8 ECU
+ SG_ Speed : 0|16@1- (1,0) [0|0] "" ECU
+)DBC";
+
+std::string unique_name(const char* tag) {
+    return std::string("/rbk_test_") + tag + "_" + std::to_string(::getpid());
+}
+
+} // namespace
+
+TEST_CASE("ShmPublisher/ShmReader: directory and per-bus rings") {
+    auto a = load_net(kDbcA);
+    auto b = load_net(kDbcB);
+    REQUIRE(a);
+    REQUIRE(b);
+    SignalCatalog cat;
+    cat.add_bus(*a);
+    cat.add_bus(*b);
+
+    ShmConfig cfg;
+    cfg.name = unique_name("dir");
+    cfg.ring_capacity = 64;
+    ShmPublisher pub(cat, cfg);
+    REQUIRE(pub.ok());
+
+    ShmReader rd;
+    std::string err;
+    REQUIRE(rd.attach(cfg.name, &err));
+    REQUIRE(rd.ring_count() == 2);
+    REQUIRE(rd.signal_count() == 3);
+    CHECK(std::string(rd.signal(2).name) == "Speed");
+    CHECK(rd.signal(2).bus == 1);
+    CHECK(rd.find_signal("Volt") == 1);
+
+    ShmSample s;
+    CHECK_FALSE(rd.next(0, s));
+
+    ParsedLine pl;
+    pl.ts_ns = 2500000000LL;
+    pl.can_id = 0x100;
+    pl.data = {25, 0xE8, 0x03, 0, 0, 0, 0, 0};
+    REQUIRE(decode_frame(pl, 0, cat, pub) == 2);
+    pl.can_id = 0x200;
+    pl.data = {0xFF, 0xFF, 0, 0, 0, 0, 0, 0};
+    REQUIRE(decode_frame(pl, 1, cat, pub) == 1);
+    Sample flagged;
+    flagged.ts_ns = pl.ts_ns;
+    flagged.signal = 2;
+    flagged.flags = kSampleOutOfRange;
+    flagged.value = 9000.0;
+    pub.begin_frame(pl, 1);
+    pub.on_sample(flagged);
+
+    REQUIRE(rd.next(0, s));
+    CHECK(s.seq == 0);
+    CHECK(s.signal == 0);
+    CHECK(s.ts_ns == 2500000000LL);
+    CHECK(s.value == 25.0);
+    CHECK(s.flags == 0);
+    REQUIRE(rd.next(0, s));
+    CHECK(s.signal == 1);
+    CHECK(s.value == Catch::Approx(100.0));
+    CHECK_FALSE(rd.next(0, s));
+
+    REQUIRE(rd.next(1, s));
+    CHECK(s.signal == 2);
+    CHECK(s.value == -1.0);
+    REQUIRE(rd.next(1, s));
+    CHECK(s.value == 9000.0);
+    CHECK(s.flags == kSampleOutOfRange);
+    CHECK(rd.lost() == 0);
+}
+
+TEST_CASE("ShmReader: slow reader is lapped, producer never blocks") {
+    auto a = load_net(kDbcA);
+    REQUIRE(a);
+    SignalCatalog cat;
+    cat.add_bus(*a);
+
+    ShmConfig cfg;
+    cfg.name = unique_name("lap");
+    cfg.ring_capacity = 8;
+    ShmPublisher pub(cat, cfg);
+    REQUIRE(pub.ok());
+
+    ShmReader rd;
+    REQUIRE(rd.attach(cfg.name));
+
+    ParsedLine pl;
+    pl.can_id = 0x100;
+    pl.data = {0, 0, 0, 0, 0, 0, 0, 0};
+    for (int i = 0; i < 10; ++i) { // 20 records into an 8-slot ring
+        pl.ts_ns = i * 1000000000LL;
+        pl.data[0] = static_cast<uint8_t>(i);
+        decode_frame(pl, 0, cat, pub);
+    }
+
+    ShmSample s;
+    REQUIRE(rd.next(0, s));
+    CHECK(s.seq == 12);
+    CHECK(rd.lost() == 12);
+    CHECK(s.value == 6.0); // Temp of frame 6
+    int more = 0;
+    while (rd.next(0, s)) ++more;
+    CHECK(more == 7);
+
+    // A late joiner that only wants new data
+    ShmReader live;
+    REQUIRE(live.attach(cfg.name));
+    live.seek_to_latest();
+    CHECK_FALSE(live.next(0, s));
+}
+
+TEST_CASE("ShmPublisher: a restart never shrinks a region under a reader") {
+    auto a = load_net(kDbcA);
+    auto b = load_net(kDbcB);
+    REQUIRE(a);
+    REQUIRE(b);
+    SignalCatalog cat;
+    cat.add_bus(*a);
+    cat.add_bus(*b);
+
+    ShmConfig cfg;
+    cfg.name = unique_name("restart");
+    cfg.ring_capacity = 1u << 12;
+    cfg.unlink_on_exit = false;
+    auto first = std::make_unique<ShmPublisher>(cat, cfg);
+    REQUIRE(first->ok());
+
+    ParsedLine pl;
+    pl.can_id = 0x200;
+    pl.data = {5, 0, 0, 0, 0, 0, 0, 0};
+    decode_frame(pl, 1, cat, *first);
+
+    ShmReader old_rd;
+    REQUIRE(old_rd.attach(cfg.name));
+
+    // Same name, far smaller rings: bus 1's old ring now lies past the new end.
+    cfg.ring_capacity = 8;
+    cfg.unlink_on_exit = true;
+    ShmPublisher second(cat, cfg);
+    REQUIRE(second.ok());
+    first.reset();
+
+    ShmSample s;
+    REQUIRE(old_rd.next(1, s)); // would be SIGBUS if the segment had been truncated
+    CHECK(s.value == 5.0);
+
+    ShmReader rd;
+    REQUIRE(rd.attach(cfg.name));
+    CHECK(rd.ring_count() == 2);
+    CHECK_FALSE(rd.next(1, s));
+}
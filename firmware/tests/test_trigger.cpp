@@ -0,0 +1,257 @@
+#include <catch2/catch_all.hpp>
+
+#include "solution/src/trigger.hpp"
+#include "tests/test_util.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace rbk;
+using namespace rbk::test;
+
+namespace {
+
+const char* kDbc = R"DBC(
+VERSION ""
+NS_ :
+BS_:
+BU_: ECU
+BO_ 256 Brakes: 8 ECU
+ SG_ Brake_Pressure : 0|16@1+ (0.1,0) [0|0] "MPa" ECU
+BO_ 171 M171_Fault_Codes: 8 ECU
+ SG_ Fault_Lo : 0|16@1+ (1,0) [0|65535] "" ECU
+ SG_ Fault_Hi : 16|16@1+ (1,0) [0|65535] "" ECU
+BO_ 512 Other: 8 ECU
+ SG_ Filler : 0|8@1+ (1,0) [0|0] "" ECU
+)DBC";
+
+struct Fixture : DbcFixture {
+    Fixture() : DbcFixture(kDbc) {
+        REQUIRE(buses.add({"can0", "test.dbc", {"vcan0"}}));
+        prefix = "rbk_trig_" + std::to_string(::getpid());
+    }
+    ~Fixture() {
+        for (int i = 1; i <= 9; ++i) std::remove((prefix + "_00" + std::to_string(i) + ".log").c_str());
+    }
+
+    // Frame i at 10 ms spacing; brake frames carry `raw` in the first word.
+    static ParsedLine frame(int i, uint32_t id, uint16_t raw) {
+        ParsedLine pl;
+        pl.ts_ns = kT0 + i * 10000000LL;
+        pl.can_id = id;
+        pl.bus = 0;
+        pl.data = {static_cast<uint8_t>(raw & 0xFF), static_cast<uint8_t>(raw >> 8), 0, 0, 0, 0, 0, 0};
+        return pl;
+    }
+
+    void feed(TriggerEngine& t, const ParsedLine& pl) {
+        t.record(pl);
+        decode_frame(pl, 0, cat, t);
+    }
+
+    std::vector<std::string> read_capture(int n) const {
+        std::ifstream is(prefix + "_00" + std::to_string(n) + ".log");
+        std::vector<std::string> lines;
+        std::string line;
+        while (std::getline(is, line)) lines.push_back(line);
+        return lines;
+    }
+
+    BusMap buses;
+    std::string prefix;
+};
+
+} // namespace
+
+TEST_CASE("trigger conditions parse", "[trigger]") {
+    TriggerSpec t;
+    REQUIRE(parse_trigger("Brake_Pressure>15", t));
+    CHECK(t.signal == "Brake_Pressure");
+    CHECK(t.op == TriggerOp::Gt);
+    CHECK(t.value == 15.0);
+    REQUIRE(parse_trigger(" M171_Fault_Codes != 0 ", t));
+    CHECK(t.signal == "M171_Fault_Codes");
+    CHECK(t.op == TriggerOp::Ne);
+    REQUIRE(parse_trigger("Temp<=-2.5", t));
+    CHECK(t.op == TriggerOp::Le);
+    CHECK(t.value == -2.5);
+    REQUIRE(parse_trigger("Relay_State==0", t));
+    CHECK(t.op == TriggerOp::Eq);
+
+    CHECK_FALSE(parse_trigger("Relay_State", t));
+    CHECK_FALSE(parse_trigger("Relay_State=0", t));
+    CHECK_FALSE(parse_trigger(">5", t));
+    CHECK_FALSE(parse_trigger("X>five", t));
+    CHECK_FALSE(parse_trigger("X>5 6", t));
+}
+
+TEST_CASE("frame ring keeps the newest frames without reallocating", "[trigger]") {
+    FrameRing ring(4);
+    const RawFrame* base = &ring.at(0);
+    for (int i = 0; i < 10; ++i) {
+        ParsedLine pl;
+        pl.ts_ns = i;
+        pl.can_id = 0x100 + i;
+        pl.data.assign(static_cast<size_t>(i % 9), static_cast<uint8_t>(i));
+        ring.push(pl);
+        CHECK(ring.size() == static_cast<size_t>(std::min(i + 1, 4)));
+    }
+    for (size_t i = 0; i < 4; ++i) {
+        CHECK(ring.at(i).ts_ns == static_cast<int64_t>(6 + i));
+        CHECK(ring.at(i).len == (6 + i) % 9);
+    }
+    const RawFrame* lo = base;
+    const RawFrame* hi = base + ring.capacity();
+    for (size_t i = 0; i < 4; ++i) CHECK((&ring.at(i) >= lo && &ring.at(i) < hi));
+
+    RawFrame f{};
+    f.ts_ns = 1705638799000001000LL;
+    f.can_id = 0x6A1;
+    f.len = 2;
+    f.data[0] = 0x0A;
+    f.data[1] = 0xF3;
+    char line[kCandumpLineLen];
+    CHECK(std::string(line, format_candump(f, "can1", line)) == "(1705638799.000001) can1 6A1#0AF3\n");
+    f.ts_ns += 7;
+    CHECK(std::string(line, format_candump(f, "can1", line)) == "(1705638799.000001007) can1 6A1#0AF3\n");
+}
+
+TEST_CASE("trigger captures the pre and post window once per edge", "[trigger]") {
+    Fixture fx;
+    TriggerConfig cfg;
+    cfg.pre_ns = 100000000;   // 10 frames
+    cfg.post_ns = 50000000;   // 5 frames
+    cfg.prefix = fx.prefix;
+    TriggerEngine t(fx.cat, fx.buses, cfg);
+    TriggerSpec spec;
+    REQUIRE(parse_trigger("Brake_Pressure > 15", spec));
+    REQUIRE(t.add(spec));
+    REQUIRE(parse_trigger("Nope > 1", spec));
+    CHECK_FALSE(t.add(spec));
+
+    // Pressure 10.0 MPa, spikes to 20.0 at frame 50..59, back down, spikes again at 100.
+    for (int i = 0; i < 200; ++i) {
+        const bool high = (i >= 50 && i < 60) || i == 100;
+        fx.feed(t, Fixture::frame(i, i % 2 ? 0x200 : 0x100, high ? 200 : 100));
+    }
+    t.finish();
+    // Odd frames are "Other"; pressure drops at 60, which re-arms for 100.
+    CHECK(t.fired() == 2);
+    CHECK(t.files().size() == 2);
+
+    const auto lines = fx.read_capture(1);
+    REQUIRE(lines.size() == 2 + 11 + 5);
+    CHECK(lines[0].find("# trigger Brake_Pressure > 15 (Brake_Pressure = 20)") == 0);
+    CHECK(lines[2].find("(1705638799.400000) can0 100#") == 0);  // frame 40
+    CHECK(lines[12].find("(1705638799.500000) can0 100#C800") == 0);  // the trigger frame
+    CHECK(lines.back().find("(1705638799.550000) can0 200#") == 0);
+
+    // The capture is a log answer can decode again.
+    ParsedLine pl;
+    CHECK_FALSE(parse_line(lines[0], pl, fx.buses));
+    REQUIRE(parse_line(lines[12], pl, fx.buses));
+    CHECK(pl.bus == 0);
+    CHECK(pl.can_id == 0x100);
+    CHECK(pl.data[0] == 0xC8);
+}
+
+TEST_CASE("message triggers, retriggers and the capture limit", "[trigger]") {
+    Fixture fx;
+    TriggerConfig cfg;
+    cfg.pre_ns = 20000000;
+    cfg.post_ns = 30000000;
+    cfg.prefix = fx.prefix;
+    cfg.max_captures = 2;
+    TriggerEngine t(fx.cat, fx.buses, cfg);
+    TriggerSpec spec;
+    REQUIRE(parse_trigger("M171_Fault_Codes!=0", spec));
+    REQUIRE(t.add(spec));
+
+    // Fault word set at 10, cleared at 12, set again at 13 (inside the
+    // first capture), then set at 40, 60 and 80.
+    auto fault = [](int i) { return (i >= 10 && i < 12) || i == 13 || i == 40 || i == 60 || i == 80; };
+    for (int i = 0; i < 100; ++i) fx.feed(t, Fixture::frame(i, 171, fault(i) ? 7 : 0));
+    t.finish();
+
+    CHECK(t.fired() == 5);
+    CHECK(t.files().size() == 2);
+    CHECK(t.suppressed() == 2);
+
+    const auto first = fx.read_capture(1);
+    size_t notes = 0;
+    for (const auto& l : first) notes += l.rfind("# trigger", 0) == 0;
+    CHECK(notes == 2);
+    // Frames 8..16: retrigger at 13 moved the end from 13 to 16.
+    CHECK(first.size() == 3 + 9);
+    CHECK(first.back().find("(1705638799.160000)") == 0);
+}
+
+TEST_CASE("a message trigger has one edge per message, not per signal", "[trigger]") {
+    Fixture fx;
+    TriggerConfig cfg;
+    cfg.pre_ns = 0;
+    cfg.post_ns = 0;
+    cfg.prefix = fx.prefix;
+    TriggerEngine t(fx.cat, fx.buses, cfg);
+    TriggerSpec spec;
+    REQUIRE(parse_trigger("M171_Fault_Codes != 0", spec));
+    REQUIRE(t.add(spec));
+
+    // Both words set at 10, only the high one at 11-12 (still active), both
+    // clear at 13, the low one alone at 20.
+    auto frame = [](int i, uint16_t lo, uint16_t hi) {
+        ParsedLine pl = Fixture::frame(i, 171, lo);
+        pl.data[2] = static_cast<uint8_t>(hi & 0xFF);
+        pl.data[3] = static_cast<uint8_t>(hi >> 8);
+        return pl;
+    };
+    for (int i = 0; i < 30; ++i) {
+        const uint16_t lo = (i == 10 || i == 20) ? 1 : 0;
+        const uint16_t hi = (i >= 10 && i < 13) ? 2 : 0;
+        fx.feed(t, frame(i, lo, hi));
+    }
+    t.finish();
+    CHECK(t.fired() == 2);
+}
+
+TEST_CASE("the ring is sized once from the pre window and peak rate", "[trigger]") {
+    Fixture fx;
+    TriggerConfig cfg;
+    cfg.pre_ns = 300 * kNsPerSec;  // 30000 frames at 10 ms
+    cfg.peak_fps = 101;
+    cfg.post_ns = 0;
+    cfg.prefix = fx.prefix;
+    TriggerEngine t(fx.cat, fx.buses, cfg);
+    TriggerSpec spec;
+    REQUIRE(parse_trigger("Brake_Pressure > 15", spec));
+    REQUIRE(t.add(spec));
+
+    for (int i = 0; i < 60000; ++i) fx.feed(t, Fixture::frame(i, 0x100, i == 59000 ? 200 : 100));
+    t.finish();
+    CHECK(t.ring_capacity() == 30300);
+    REQUIRE(t.fired() == 1);
+
+    const auto lines = fx.read_capture(1);
+    REQUIRE(lines.size() == 2 + 30001);
+    CHECK(lines[2].find("(1705639089.000000) can0 100#") == 0);  // frame 29000
+
+    // A fixed ring stays as given and says so when it falls short.
+    cfg.ring_frames = 1000;
+    cfg.prefix = fx.prefix + "_fixed";
+    TriggerEngine fixed(fx.cat, fx.buses, cfg);
+    REQUIRE(fixed.add(spec));
+    for (int i = 0; i < 3000; ++i) fx.feed(fixed, Fixture::frame(i, 0x100, i == 2500 ? 200 : 100));
+    fixed.finish();
+    CHECK(fixed.ring_capacity() == 1000);
+    std::ifstream is(cfg.prefix + "_001.log");
+    std::string line;
+    std::getline(is, line);
+    std::getline(is, line);
+    std::getline(is, line);
+    CHECK(line.find("# history starts at") == 0);
+    is.close();
+    std::remove((cfg.prefix + "_001.log").c_str());
+}
@@ -0,0 +1,52 @@
+#pragma once
+// Helpers shared by the solution_tests sources. Include after Catch2.
+
+#include "solution/src/sample_sink.hpp"
+#include "solution/src/signal_catalog.hpp"
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace rbk::test {
+
+// 2024-01-19 04:33:19 UTC, the epoch of the sample logs.
+constexpr int64_t kT0 = 1705638799000000000LL;
+
+inline std::unique_ptr<dbcppp::INetwork> load_net(const char* dbc) {
+    std::istringstream is(dbc);
+    return dbcppp::INetwork::LoadDBCFromIs(is);
+}
+
+// A network parsed from inline DBC text, catalogued as bus 0.
+struct DbcFixture {
+    explicit DbcFixture(const char* dbc) : net(load_net(dbc)) {
+        REQUIRE(net);
+        cat.add_bus(*net);
+    }
+    std::unique_ptr<dbcppp::INetwork> net;
+    SignalCatalog cat;
+};
+
+// Records exactly what a sink is handed.
+struct Recorder : SampleSink {
+    std::vector<Sample> got;
+    int frames = 0;
+    void begin_frame(const ParsedLine&, uint8_t) override { ++frames; }
+    void on_sample(const Sample& s) override { got.push_back(s); }
+};
+
+// Per-process scratch file in the working directory.
+inline std::string temp_path(const char* tag) {
+    return std::string("rbk_test_") + tag + "_" + std::to_string(::getpid()) + ".txt";
+}
+
+inline std::string slurp(const std::string& path) {
+    std::ifstream is(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+}
+
+} // namespace rbk::test